@@ -72,13 +72,37 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("WifiSimpleAdhoc");
 Time ts;
+// Latency of every received packet in ms, written out after the run
+std::vector<int64_t> latencies;
+std::string latencyFile = "myfirst-latency.csv";
+Ptr<aodv::ForwardingTraceSink> forwarding;
+
+void WriteResults()
+{
+  forwarding->Flush();
+  std::ofstream latency(latencyFile.c_str());
+  latency << "packet,latency_ms\n";
+  for (uint32_t k = 0; k < latencies.size(); k++)
+  {
+    latency << k << "," << latencies[k] << "\n";
+  }
+  latency.close();
+  NS_LOG_UNCOND("Received " << latencies.size() << " packets, "
+                << forwarding->GetRecords() << " forwarding decisions");
+}
+
+// The network lifetime ends when the first node runs out of energy
+void NodeDepleted(Ptr<Node> node)
+{
+  NS_LOG_UNCOND("Node " << node->GetId() << " out of energy at " << Simulator::Now().GetSeconds() << "s");
+  Simulator::Stop();
+}
 
 void ReceivePacket(Ptr<Socket> socket)
 {
   while (socket->Recv())
   {
-    NS_LOG_UNCOND("Received one packet!");
-    NS_LOG_UNCOND("latop:"<<(Simulator::Now()-ts).GetMilliSeconds());
+    latencies.push_back((Simulator::Now()-ts).GetMilliSeconds());
   }
 }
 
@@ -94,9 +118,13 @@ static void GenerateTraffic(Ptr<Socket> socket, uint32_t pktSize,
     ahp.SetPreviousEnergy(ncc->GetSelfEnergy());
     ahp.SetDstAddress(Ipv4Address("10.1.1.1"));
     pk->AddHeader(ahp);
-    ncc->SelfEnergyInDe(100, false);
+    if (!ncc->SelfEnergyInDe(100, false))
+    {
+      // The source is a node too, its depletion ends the run
+      NodeDepleted(ncc);
+      return;
+    }
     socket->Send(pk);
-    std::cout << "New packet!" << std::endl;
     ts = Simulator::Now();
     Simulator::Schedule(pktInterval, &GenerateTraffic,
                         socket, pktSize, pktCount - 1, pktInterval, ncc);
@@ -115,6 +143,7 @@ int main(int argc, char *argv[])
   uint32_t numPackets = 500;
   double interval = 5; // seconds
   bool verbose = false;
+  std::string traceFile = "myfirst-forwarding.csv";
   int numNodes = 25;
   // double gridsize = 1000.0;
   double mr = 150;
@@ -144,6 +173,8 @@ int main(int argc, char *argv[])
   cmd.AddValue("numPackets", "number of packets generated", numPackets);
   cmd.AddValue("interval", "interval (seconds) between packets", interval);
   cmd.AddValue("verbose", "turn on all WifiNetDevice log components", verbose);
+  cmd.AddValue("traceFile", "CSV file of the next hop decisions", traceFile);
+  cmd.AddValue("latencyFile", "CSV file of the latency of received packets", latencyFile);
 
   cmd.Parse(argc, argv);
   // Convert to time object
@@ -232,6 +263,11 @@ int main(int argc, char *argv[])
 
   // Tracing
   wifiPhy.EnablePcap("wifi-simple-adhoc", devices);
+  forwarding = Create<aodv::ForwardingTraceSink>(traceFile);
+  AodvHelper::EnableForwardingTrace(forwarding);
+  latencies.reserve(numPackets);
+  Config::ConnectWithoutContext("/NodeList/*/$ns3::aodv::RoutingProtocol/EnergyDepleted",
+                                MakeCallback(&NodeDepleted));
 
   // Output what we are doing
   NS_LOG_UNCOND("Testing " << numPackets << " packets sent with receiver rss " << rss);
@@ -247,6 +283,7 @@ int main(int argc, char *argv[])
                                  source, packetSize, numPackets, interPacketInterval, c.Get(0));
 
   Simulator::Run();
+  WriteResults();
   Simulator::Destroy ();
 
   return 0;
@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the cost of the packet metadata on the AODV forwarding path.
+ *
+ * A UDP flow crosses a chain of AODV nodes.  The packet metadata is
+ * disabled, enabled, or sampled, and the program reports the wall clock
+ * time per forwarded packet.  The metadata cannot be disabled once
+ * enabled, so each mode is a separate run:
+ *
+ *   ./waf --run "aodv-metadata-bench --metadata=off"
+ *   ./waf --run "aodv-metadata-bench --metadata=on"
+ *   ./waf --run "aodv-metadata-bench --metadata=sampled --period=100"
+ *
+ * With --ascii=1, every PHY event is printed to an ASCII trace: this is
+ * where the metadata is actually used.
+ */
+
+#include "ns3/aodv-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include <iostream>
+#include <limits>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AodvMetadataBench");
+
+/**
+ * \brief UDP flow over a chain of AODV nodes.
+ */
+class AodvMetadataBench
+{
+public:
+  AodvMetadataBench ();
+  /// Configure script parameters, \return true on successful configuration
+  bool Configure (int argc, char **argv);
+  /// Run simulation, \return the wall clock time, in ms
+  int64_t Run ();
+  /// Report results
+  void Report (std::ostream & os, int64_t ms);
+
+private:
+  // parameters
+  /// Number of nodes
+  uint32_t size;
+  /// Distance between nodes, meters
+  double step;
+  /// Simulation time, seconds
+  double totalTime;
+  /// Interval between packets, microseconds
+  uint32_t interval;
+  /// Size of the UDP payload, bytes
+  uint32_t packetSize;
+  /// Packet metadata: off, on or sampled
+  std::string metadata;
+  /// Sampling period of the sampled mode
+  uint32_t period;
+  /// Write an ASCII trace if true
+  bool ascii;
+
+  // network
+  NodeContainer nodes;
+  NetDeviceContainer devices;
+  Ipv4InterfaceContainer interfaces;
+  Ptr<Socket> source;
+  Ptr<Socket> sink;
+  /// Number of packets sent
+  uint32_t sent;
+  /// Number of packets received
+  uint32_t received;
+
+private:
+  void CreateNodes ();
+  void CreateDevices ();
+  void InstallInternetStack ();
+  void InstallApplications ();
+  void Send ();
+  void Receive (Ptr<Socket> socket);
+};
+
+int main (int argc, char **argv)
+{
+  AodvMetadataBench bench;
+  if (!bench.Configure (argc, argv))
+    NS_FATAL_ERROR ("Configuration failed. Aborted.");
+
+  int64_t ms = bench.Run ();
+  bench.Report (std::cout, ms);
+  return 0;
+}
+
+AodvMetadataBench::AodvMetadataBench () :
+  size (5),
+  step (50),
+  totalTime (10),
+  interval (500),
+  packetSize (512),
+  metadata ("off"),
+  period (100),
+  ascii (false),
+  sent (0),
+  received (0)
+{
+}
+
+bool
+AodvMetadataBench::Configure (int argc, char **argv)
+{
+  SeedManager::SetSeed (12345);
+  CommandLine cmd;
+
+  cmd.AddValue ("size", "Number of nodes.", size);
+  cmd.AddValue ("step", "Distance between nodes, m.", step);
+  cmd.AddValue ("time", "Simulation time, s.", totalTime);
+  cmd.AddValue ("interval", "Interval between packets, us.", interval);
+  cmd.AddValue ("packetSize", "Size of the UDP payload, bytes.", packetSize);
+  cmd.AddValue ("metadata", "Packet metadata: off, on or sampled.", metadata);
+  cmd.AddValue ("period", "Sampling period of --metadata=sampled.", period);
+  cmd.AddValue ("ascii", "Write an ASCII trace.", ascii);
+
+  cmd.Parse (argc, argv);
+
+  if (metadata == "on")
+    {
+      Packet::EnablePrinting ();
+    }
+  else if (metadata == "sampled")
+    {
+      Packet::EnableSampledPrinting (period);
+    }
+  else if (metadata != "off")
+    {
+      return false;
+    }
+  return size >= 2;
+}
+
+int64_t
+AodvMetadataBench::Run ()
+{
+  CreateNodes ();
+  CreateDevices ();
+  InstallInternetStack ();
+  InstallApplications ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (totalTime));
+  Simulator::Run ();
+  int64_t ms = clock.End ();
+  Simulator::Destroy ();
+  return ms;
+}
+
+void
+AodvMetadataBench::Report (std::ostream & os, int64_t ms)
+{
+  os << "metadata=" << metadata;
+  if (metadata == "sampled")
+    {
+      os << " period=" << period;
+    }
+  os << " sent=" << sent << " received=" << received
+     << " wall=" << ms << " ms";
+  if (received > 0)
+    {
+      os << " us/packet=" << ms * 1000.0 / received;
+    }
+  os << std::endl;
+}
+
+void
+AodvMetadataBench::CreateNodes ()
+{
+  nodes.Create (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      // Enough for the whole run: a depleted node leaves the network
+      nodes.Get (i)->SetSelfEnergy (std::numeric_limits<uint32_t>::max ());
+    }
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (0.0),
+                                 "MinY", DoubleValue (0.0),
+                                 "DeltaX", DoubleValue (step),
+                                 "DeltaY", DoubleValue (0),
+                                 "GridWidth", UintegerValue (size),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+}
+
+void
+AodvMetadataBench::CreateDevices ()
+{
+  WifiMacHelper wifiMac;
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  // Only the next nodes of the chain are in range
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel",
+                                  "MaxRange", DoubleValue (step * 1.5));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("OfdmRate54Mbps"));
+  devices = wifi.Install (wifiPhy, wifiMac, nodes);
+
+  if (ascii)
+    {
+      AsciiTraceHelper asciiHelper;
+      wifiPhy.EnableAsciiAll (asciiHelper.CreateFileStream ("aodv-metadata-bench.tr"));
+    }
+}
+
+void
+AodvMetadataBench::InstallInternetStack ()
+{
+  AodvHelper aodv;
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (aodv);
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.0.0.0");
+  interfaces = address.Assign (devices);
+}
+
+void
+AodvMetadataBench::InstallApplications ()
+{
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  sink = Socket::CreateSocket (nodes.Get (size - 1), tid);
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&AodvMetadataBench::Receive, this));
+
+  source = Socket::CreateSocket (nodes.Get (0), tid);
+  source->Connect (InetSocketAddress (interfaces.GetAddress (size - 1), 9));
+  Simulator::Schedule (Seconds (1), &AodvMetadataBench::Send, this);
+}
+
+void
+AodvMetadataBench::Send ()
+{
+  // The AODV forwarding path reads the previous hop from this header
+  Ptr<Packet> packet = Create<Packet> (packetSize);
+  aodv::addHeader header;
+  header.SetPreviousHop (interfaces.GetAddress (0));
+  header.SetDstAddress (interfaces.GetAddress (0));
+  packet->AddHeader (header);
+  source->Send (packet);
+  sent++;
+  Simulator::Schedule (MicroSeconds (interval), &AodvMetadataBench::Send, this);
+}
+
+void
+AodvMetadataBench::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      received++;
+    }
+}
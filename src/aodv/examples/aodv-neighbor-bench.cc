@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the AODV neighbor table against the plain vector it replaced.
+ */
+
+#include "ns3/aodv-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Linear-scan neighbor list, as aodv::Neighbors used to be.
+ *
+ * Only the operations exercised by the benchmark are kept, RouteDecision
+ * and GetMnsEnergy are the original two-pass scan and mean.
+ */
+class VectorNeighbors
+{
+public:
+  VectorNeighbors (Time delay) : m_ntimer (Timer::CANCEL_ON_DESTROY), mns_energy (0)
+  {
+    m_ntimer.SetDelay (delay);
+    m_ntimer.SetFunction (&VectorNeighbors::Purge, this);
+  }
+  bool IsNeighbor (Ipv4Address addr)
+  {
+    Purge ();
+    for (std::vector<aodv::Neighbors::Neighbor>::const_iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+      {
+        if (i->m_neighborAddress == addr)
+          return true;
+      }
+    return false;
+  }
+  Time GetExpireTime (Ipv4Address addr)
+  {
+    Purge ();
+    for (std::vector<aodv::Neighbors::Neighbor>::const_iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+      {
+        if (i->m_neighborAddress == addr)
+          return (i->m_expireTime - Simulator::Now ());
+      }
+    return Seconds (0);
+  }
+  void Update (Ipv4Address addr, Time expire, uint32_t me, float mv, uint32_t mql, uint32_t mns_e)
+  {
+    for (std::vector<aodv::Neighbors::Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+      if (i->m_neighborAddress == addr)
+        {
+          i->m_energy = me; i->m_queuelength = mql; i->v_value = mv; i->mns_energy = mns_e;
+          i->timestamp = Simulator::Now ();
+          i->m_expireTime = std::max (expire + Simulator::Now (), i->m_expireTime);
+          return;
+        }
+    m_nb.push_back (aodv::Neighbors::Neighbor (addr, Mac48Address (), expire + Simulator::Now (), me, mv, mql, mns_e));
+    Purge ();
+  }
+  void Purge ()
+  {
+    if (m_nb.empty ())
+      return;
+    m_nb.erase (std::remove_if (m_nb.begin (), m_nb.end (), Expired ()), m_nb.end ());
+    m_ntimer.Cancel ();
+    m_ntimer.Schedule ();
+  }
+  uint32_t GetSize () const { return m_nb.size (); }
+  uint32_t GetMnsEnergy ()
+  {
+    if (m_nb.size () == 0)
+      mns_energy = 0.0;
+    else
+      {
+        uint32_t averE = 0;
+        for (uint32_t index = 0; index < m_nb.size (); index++)
+          {
+            averE += m_nb[index].m_energy;
+          }
+        mns_energy = (uint32_t)(averE / m_nb.size ());
+      }
+    return mns_energy;
+  }
+  Ipv4Address RouteDecision (Ptr<Node> nd, const Ipv4Address & preHop, const Ipv4Address & dst)
+  {
+    uint32_t se = nd->GetSelfEnergy ();
+    float sv = nd->GetSelfV_value ();
+    float nmax = 0.0;
+    uint32_t idx = 0;
+    Ipv4Address sr = Ipv4Address ("10.1.1.1");
+    for (uint32_t index = 0; index < m_nb.size (); index++)
+      {
+        aodv::Neighbors::Neighbor &cr = m_nb.at (index);
+        Time cu = Simulator::Now () - cr.timestamp;
+        if (cr.m_neighborAddress.IsEqual (preHop) || cr.m_neighborAddress.IsEqual (sr))
+          {
+            cr.q_value = -1000000;
+            continue;
+          }
+        else
+          {
+            if (cr.m_neighborAddress.IsEqual (dst))
+              {
+                cr.q_value = 0;
+                continue;
+              }
+            float r_t = 0.9 * (-1.0 + 0.5 * cr.m_energy / 1000000.0 + 0.5 * 2.0 / 3.1415927 * atan ((float)(cr.m_energy - cr.mns_energy) / 1000000.0) + 0.5 * (-1.0 / 50.0 * cu.GetMilliSeconds ()))
+              + 0.1 * (-1.0 + 0.5 * se / 1000000.0 + 0.5 * 2.0 / 3.1415927 * atan ((float)(se - mns_energy) / 1000000.0) - 0.5 * 0.8);
+            cr.q_value = r_t + 0.9 * (0.7 * cr.v_value + 0.3 * sv);
+          }
+      }
+    for (uint32_t index = 0; index < m_nb.size (); index++)
+      {
+        aodv::Neighbors::Neighbor &cr = m_nb.at (index);
+        if (m_nb.size () == 1)
+          {
+            idx = 0;
+            break;
+          }
+        if (index == 0)
+          {
+            nmax = cr.q_value;
+            continue;
+          }
+        else
+          {
+            if (cr.q_value > nmax)
+              {
+                nmax = cr.q_value;
+                idx = index;
+              }
+          }
+      }
+    nd->SetSelfV_value (nmax);
+    return m_nb.at (idx).m_neighborAddress;
+  }
+
+private:
+  struct Expired
+  {
+    bool operator() (const aodv::Neighbors::Neighbor & nb) const
+    {
+      return ((nb.m_expireTime < Simulator::Now ()) || nb.close);
+    }
+  };
+  Timer m_ntimer;
+  std::vector<aodv::Neighbors::Neighbor> m_nb;
+  uint32_t mns_energy;
+};
+
+/**
+ * \brief Replay of hello rounds and forwarding lookups on a neighbor table.
+ *
+ * Every round all live neighbors send a hello, a share of them goes silent
+ * (and expires) while fresh ones appear, and the forwarding path queries
+ * the table several times per hello. Next hop decisions are timed
+ * separately.
+ */
+template <typename Table>
+class NeighborWorkload
+{
+public:
+  NeighborWorkload (uint32_t neighbors, uint32_t rounds, uint32_t lookups, uint32_t decisions, double churn)
+    : m_table (Seconds (1)),
+      m_neighbors (neighbors),
+      m_rounds (rounds),
+      m_lookups (lookups),
+      m_decisions (decisions),
+      m_churn (churn),
+      m_next (0),
+      m_found (0),
+      m_choices (0),
+      m_decisionMs (0)
+  {
+    m_node = CreateObject<Node> ();
+    m_node->SetSelfEnergy (1000000);
+    m_node->SetSelfV_value (0);
+  }
+  /// Run all rounds and return the wall clock time, in ms
+  int64_t Run ()
+  {
+    for (uint32_t i = 0; i < m_neighbors; ++i)
+      {
+        m_live.push_back (NextAddress ());
+      }
+    for (uint32_t r = 0; r < m_rounds; ++r)
+      {
+        Simulator::Schedule (MilliSeconds (250 * r), &NeighborWorkload::Round, this);
+      }
+    SystemWallClockMs clock;
+    clock.Start ();
+    Simulator::Run ();
+    int64_t ms = clock.End ();
+    Simulator::Destroy ();
+    return ms;
+  }
+  uint32_t GetFound () const { return m_found; }
+  /// Sum of the addresses of all chosen next hops
+  uint64_t GetChoices () const { return m_choices; }
+  /// Wall clock time spent in RouteDecision, in ms
+  int64_t GetDecisionMs () const { return m_decisionMs; }
+
+private:
+  Ipv4Address NextAddress ()
+  {
+    return Ipv4Address (0x0a000000 + (++m_next));
+  }
+  void Round ()
+  {
+    uint32_t silent = m_churn * m_live.size ();
+    for (uint32_t i = 0; i < silent; ++i)
+      {
+        m_live[(i * 7919 + m_next) % m_live.size ()] = NextAddress ();
+      }
+    for (uint32_t i = 0; i < m_live.size (); ++i)
+      {
+        m_table.Update (m_live[i], Seconds (2), 1000000 - i, 0.5, 0, 900000);
+        for (uint32_t j = 0; j < m_lookups; ++j)
+          {
+            Ipv4Address addr = m_live[(i + j * 31) % m_live.size ()];
+            m_found += m_table.IsNeighbor (addr);
+            m_found += m_table.GetExpireTime (addr).IsStrictlyPositive ();
+          }
+      }
+    // As when the hello of this node is sent
+    m_table.GetMnsEnergy ();
+    SystemWallClockMs clock;
+    clock.Start ();
+    for (uint32_t i = 0; i < m_decisions; ++i)
+      {
+        Ipv4Address nextHop = m_table.RouteDecision (m_node, m_live[i % m_live.size ()], m_live[(i + 1) % m_live.size ()]);
+        m_choices += nextHop.Get ();
+      }
+    m_decisionMs += clock.End ();
+  }
+
+  Table m_table;
+  std::vector<Ipv4Address> m_live;
+  uint32_t m_neighbors;
+  uint32_t m_rounds;
+  uint32_t m_lookups;
+  uint32_t m_decisions;
+  double m_churn;
+  uint32_t m_next;
+  uint32_t m_found;
+  uint64_t m_choices;
+  int64_t m_decisionMs;
+  Ptr<Node> m_node;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minNeighbors = 4;
+  uint32_t maxNeighbors = 512;
+  uint32_t rounds = 40;
+  uint32_t lookups = 4;
+  uint32_t decisions = 20000;
+  double churn = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("minNeighbors", "Smallest neighborhood size", minNeighbors);
+  cmd.AddValue ("maxNeighbors", "Largest neighborhood size, doubled from minNeighbors", maxNeighbors);
+  cmd.AddValue ("rounds", "Hello rounds per run", rounds);
+  cmd.AddValue ("lookups", "IsNeighbor/GetExpireTime pairs per received hello", lookups);
+  cmd.AddValue ("decisions", "Next hop decisions per round", decisions);
+  cmd.AddValue ("churn", "Share of neighbors replaced every round", churn);
+  cmd.Parse (argc, argv);
+
+  std::cout << "neighbors\tvector (ms)\tindexed (ms)\tvector (ns/decision)\tranked (ns/decision)" << std::endl;
+  double nsPerDecision = 1e6 / ((double) rounds * decisions);
+  for (uint32_t n = minNeighbors; n <= maxNeighbors; n *= 2)
+    {
+      NeighborWorkload<VectorNeighbors> plain (n, rounds, lookups, decisions, churn);
+      int64_t plainMs = plain.Run ();
+      NeighborWorkload<aodv::Neighbors> indexed (n, rounds, lookups, decisions, churn);
+      int64_t indexedMs = indexed.Run ();
+      NS_ABORT_MSG_UNLESS (plain.GetFound () == indexed.GetFound (), "Neighbor tables disagree");
+      NS_ABORT_MSG_UNLESS (plain.GetChoices () == indexed.GetChoices (), "Next hop decisions disagree");
+      std::cout << n << "\t\t" << plainMs - plain.GetDecisionMs () << "\t\t" << indexedMs - indexed.GetDecisionMs ()
+                << "\t\t" << plain.GetDecisionMs () * nsPerDecision << "\t\t\t" << indexed.GetDecisionMs () * nsPerDecision << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,249 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the AODV routing table against the full-scan table it replaced.
+ */
+
+#include "ns3/aodv-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::aodv;
+
+/**
+ * \brief Routing table scanning all entries on Purge and link breaks, as
+ * aodv::RoutingTable used to.
+ *
+ * Only the operations exercised by the benchmark are kept.
+ */
+class ScanRoutingTable
+{
+public:
+  ScanRoutingTable (Time t) : m_badLinkLifetime (t) {}
+  bool AddRoute (RoutingTableEntry & rt)
+  {
+    Purge ();
+    return m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt)).second;
+  }
+  bool LookupRoute (Ipv4Address id, RoutingTableEntry & rt)
+  {
+    Purge ();
+    std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = m_ipv4AddressEntry.find (id);
+    if (i == m_ipv4AddressEntry.end ())
+      return false;
+    rt = i->second;
+    return true;
+  }
+  bool LookupValidRoute (Ipv4Address id, RoutingTableEntry & rt)
+  {
+    return LookupRoute (id, rt) && rt.GetFlag () == VALID;
+  }
+  bool Update (RoutingTableEntry & rt)
+  {
+    std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.find (rt.GetDestination ());
+    if (i == m_ipv4AddressEntry.end ())
+      return false;
+    i->second = rt;
+    return true;
+  }
+  void GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable)
+  {
+    Purge ();
+    unreachable.clear ();
+    for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+      {
+        if (i->second.GetNextHop () == nextHop)
+          unreachable.insert (std::make_pair (i->first, i->second.GetSeqNo ()));
+      }
+  }
+  void InvalidateRoutesWithDst (std::map<Ipv4Address, uint32_t> const & unreachable)
+  {
+    Purge ();
+    for (std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+      {
+        for (std::map<Ipv4Address, uint32_t>::const_iterator j = unreachable.begin (); j != unreachable.end (); ++j)
+          {
+            if ((i->first == j->first) && (i->second.GetFlag () == VALID))
+              i->second.Invalidate (m_badLinkLifetime);
+          }
+      }
+  }
+  void Purge ()
+  {
+    for (std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end ();)
+      {
+        if (i->second.GetLifeTime () < Seconds (0) && i->second.GetFlag () == INVALID)
+          {
+            m_ipv4AddressEntry.erase (i++);
+            continue;
+          }
+        if (i->second.GetLifeTime () < Seconds (0) && i->second.GetFlag () == VALID)
+          i->second.Invalidate (m_badLinkLifetime);
+        ++i;
+      }
+  }
+
+private:
+  std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  Time m_badLinkLifetime;
+};
+
+/**
+ * \brief Replay of route lookups and link breaks on a routing table.
+ *
+ * Routes to all destinations are installed at the start with lifetimes
+ * spread over several seconds. Every round the forwarding path looks
+ * routes up and refreshes the ones it uses, so that the others expire.
+ * Link breaks then collect the destinations behind a next hop and
+ * invalidate them, as RERR generation does.
+ */
+template <typename Table>
+class RoutingTableWorkload
+{
+public:
+  RoutingTableWorkload (uint32_t destinations, uint32_t neighbors, uint32_t rounds, uint32_t lookups, uint32_t breaks)
+    : m_table (Seconds (3)),
+      m_destinations (destinations),
+      m_neighbors (neighbors),
+      m_rounds (rounds),
+      m_lookups (lookups),
+      m_breaks (breaks),
+      m_found (0),
+      m_unreachable (0),
+      m_lookupMs (0),
+      m_rerrMs (0)
+  {
+  }
+  void Run ()
+  {
+    Simulator::Schedule (Seconds (0), &RoutingTableWorkload::Install, this);
+    for (uint32_t r = 0; r < m_rounds; ++r)
+      {
+        Simulator::Schedule (MilliSeconds (500 * r + 1), &RoutingTableWorkload::Round, this, r);
+      }
+    Simulator::Schedule (MilliSeconds (500 * m_rounds + 1), &RoutingTableWorkload::Break, this);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+  uint32_t GetFound () const { return m_found; }
+  uint32_t GetUnreachable () const { return m_unreachable; }
+  /// Wall clock time spent in lookups, in ms
+  int64_t GetLookupMs () const { return m_lookupMs; }
+  /// Wall clock time spent collecting and invalidating routes on link breaks, in ms
+  int64_t GetRerrMs () const { return m_rerrMs; }
+
+private:
+  Ipv4Address Destination (uint32_t i) const
+  {
+    return Ipv4Address (0x0a000000 + m_neighbors + i);
+  }
+  Ipv4Address Neighbor (uint32_t i) const
+  {
+    return Ipv4Address (0x0a000000 + i % m_neighbors);
+  }
+  void Install ()
+  {
+    Ptr<NetDevice> dev;
+    Ipv4InterfaceAddress iface;
+    for (uint32_t i = 0; i < m_destinations; ++i)
+      {
+        RoutingTableEntry rt (dev, Destination (i), true, i, iface, 3, Neighbor (i * 7),
+                              MilliSeconds (1000 + (i * 7919) % 9000));
+        m_table.AddRoute (rt);
+      }
+  }
+  void Round (uint32_t r)
+  {
+    SystemWallClockMs clock;
+    clock.Start ();
+    RoutingTableEntry rt;
+    for (uint32_t i = 0; i < m_lookups; ++i)
+      {
+        // The first half of the destinations carries traffic, the rest expires
+        uint32_t dst = (i * 31 + r * 17) % (m_destinations / 2);
+        if (m_table.LookupValidRoute (Destination (dst), rt))
+          {
+            ++m_found;
+            rt.SetLifeTime (Seconds (3));
+            m_table.Update (rt);
+          }
+      }
+    m_lookupMs += clock.End ();
+  }
+  void Break ()
+  {
+    SystemWallClockMs clock;
+    clock.Start ();
+    std::map<Ipv4Address, uint32_t> unreachable;
+    for (uint32_t i = 0; i < m_breaks; ++i)
+      {
+        m_table.GetListOfDestinationWithNextHop (Neighbor (i), unreachable);
+        m_table.InvalidateRoutesWithDst (unreachable);
+        m_unreachable += unreachable.size ();
+      }
+    m_rerrMs += clock.End ();
+  }
+
+  Table m_table;
+  uint32_t m_destinations;
+  uint32_t m_neighbors;
+  uint32_t m_rounds;
+  uint32_t m_lookups;
+  uint32_t m_breaks;
+  uint32_t m_found;
+  uint32_t m_unreachable;
+  int64_t m_lookupMs;
+  int64_t m_rerrMs;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minDestinations = 625;
+  uint32_t maxDestinations = 10000;
+  uint32_t neighbors = 32;
+  uint32_t rounds = 20;
+  uint32_t lookups = 2000;
+  uint32_t breaks = 32;
+
+  CommandLine cmd;
+  cmd.AddValue ("minDestinations", "Smallest routing table size", minDestinations);
+  cmd.AddValue ("maxDestinations", "Largest routing table size, doubled from minDestinations", maxDestinations);
+  cmd.AddValue ("neighbors", "Next hops the destinations are spread over", neighbors);
+  cmd.AddValue ("rounds", "Lookup rounds, 500 ms apart", rounds);
+  cmd.AddValue ("lookups", "Route lookups per round", lookups);
+  cmd.AddValue ("breaks", "Link breaks after the last round", breaks);
+  cmd.Parse (argc, argv);
+
+  std::cout << "destinations\tscan (ns/lookup)\tindexed (ns/lookup)\tscan (us/break)\tindexed (us/break)" << std::endl;
+  double nsPerLookup = 1e6 / ((double) rounds * lookups);
+  double usPerBreak = 1e3 / (double) breaks;
+  for (uint32_t n = minDestinations; n <= maxDestinations; n *= 2)
+    {
+      RoutingTableWorkload<ScanRoutingTable> scan (n, neighbors, rounds, lookups, breaks);
+      scan.Run ();
+      RoutingTableWorkload<RoutingTable> indexed (n, neighbors, rounds, lookups, breaks);
+      indexed.Run ();
+      NS_ABORT_MSG_UNLESS (scan.GetFound () == indexed.GetFound (), "Routing tables disagree on lookups");
+      NS_ABORT_MSG_UNLESS (scan.GetUnreachable () == indexed.GetUnreachable (), "Routing tables disagree on link breaks");
+      std::cout << n << "\t\t" << scan.GetLookupMs () * nsPerLookup << "\t\t\t" << indexed.GetLookupMs () * nsPerLookup
+                << "\t\t\t" << scan.GetRerrMs () * usPerBreak << "\t\t" << indexed.GetRerrMs () * usPerBreak << std::endl;
+    }
+  return 0;
+}
@@ -23,12 +23,14 @@
 #include "ns3/names.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/config.h"
 
 namespace ns3
 {
 
 AodvHelper::AodvHelper() : 
-  Ipv4RoutingHelper ()
+  Ipv4RoutingHelper (),
+  m_hasPolicy (false)
 {
   m_agentFactory.SetTypeId ("ns3::aodv::RoutingProtocol");
 }
@@ -43,6 +45,10 @@ Ptr<Ipv4RoutingProtocol>
 AodvHelper::Create (Ptr<Node> node) const
 {
   Ptr<aodv::RoutingProtocol> agent = m_agentFactory.Create<aodv::RoutingProtocol> ();
+  if (m_hasPolicy)
+    {
+      agent->SetRewardPolicy (m_policyFactory.Create<aodv::RewardPolicy> ());
+    }
   node->AggregateObject (agent);
   return agent;
 }
@@ -53,6 +59,22 @@ AodvHelper::Set (std::string name, const AttributeValue &value)
   m_agentFactory.Set (name, value);
 }
 
+void
+AodvHelper::SetRewardPolicy (std::string type,
+                             std::string n0, const AttributeValue &v0,
+                             std::string n1, const AttributeValue &v1,
+                             std::string n2, const AttributeValue &v2,
+                             std::string n3, const AttributeValue &v3)
+{
+  m_policyFactory = ObjectFactory ();
+  m_policyFactory.SetTypeId (type);
+  m_policyFactory.Set (n0, v0);
+  m_policyFactory.Set (n1, v1);
+  m_policyFactory.Set (n2, v2);
+  m_policyFactory.Set (n3, v3);
+  m_hasPolicy = true;
+}
+
 int64_t
 AodvHelper::AssignStreams (NodeContainer c, int64_t stream)
 {
@@ -93,4 +115,11 @@ AodvHelper::AssignStreams (NodeContainer c, int64_t stream)
   return (currentStream - stream);
 }
 
+void
+AodvHelper::EnableForwardingTrace (Ptr<aodv::ForwardingTraceSink> sink)
+{
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::aodv::RoutingProtocol/Forward",
+                                 MakeCallback (&aodv::ForwardingTraceSink::Record, sink));
+}
+
 }
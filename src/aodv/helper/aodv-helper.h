@@ -25,6 +25,7 @@
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/aodv-forwarding-trace.h"
 
 namespace ns3
 {
@@ -62,6 +63,26 @@ public:
    * This method controls the attributes of ns3::aodv::RoutingProtocol
    */
   void Set (std::string name, const AttributeValue &value);
+  /**
+   * \param type the type of ns3::aodv::RewardPolicy to create
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   *
+   * Every routing protocol created by this helper gets its own reward
+   * policy of this type, instead of the one given by the RewardPolicy
+   * attribute.
+   */
+  void SetRewardPolicy (std::string type,
+                        std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                        std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                        std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                        std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -74,10 +95,21 @@ public:
    * \return the number of stream indices assigned by this helper
    */
   int64_t AssignStreams (NodeContainer c, int64_t stream);
+  /**
+   * \param sink sink to receive the records
+   *
+   * Connect the Forward trace source of all installed AODV routing
+   * protocols to sink.
+   */
+  static void EnableForwardingTrace (Ptr<aodv::ForwardingTraceSink> sink);
 
 private:
   /** the factory to create AODV routing object */
   ObjectFactory m_agentFactory;
+  /** the factory to create the reward policy of every AODV routing object */
+  ObjectFactory m_policyFactory;
+  /** true if SetRewardPolicy has been called */
+  bool m_hasPolicy;
 };
 
 }
@@ -51,6 +51,10 @@ public:
   void SetLifetime (Time lifetime);
   /// Get duplicate records lifetimes
   Time GetLifetime () const;
+  /// Select how packet IDs are remembered, see IdCache::SetMode
+  void SetMode (enum IdCache::Mode mode, uint32_t capacity, double falsePositiveRate) { m_idCache.SetMode (mode, capacity, falsePositiveRate); }
+  /// Return lookup counters and memory use
+  IdCache::Stats GetStats () const { return m_idCache.GetStats (); }
 private:
   /// Impl
   IdCache m_idCache;
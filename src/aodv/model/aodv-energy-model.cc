@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-energy-model.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("AodvEnergyModel");
+
+namespace aodv
+{
+
+NS_OBJECT_ENSURE_REGISTERED (RoutingEnergyModel);
+
+TypeId
+RoutingEnergyModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::RoutingEnergyModel")
+    .SetParent<DeviceEnergyModel> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<RoutingEnergyModel> ()
+  ;
+  return tid;
+}
+
+RoutingEnergyModel::RoutingEnergyModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RoutingEnergyModel::~RoutingEnergyModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RoutingEnergyModel::SetEnergySource (Ptr<EnergySource> source)
+{
+  NS_LOG_FUNCTION (this << source);
+  m_source = source;
+}
+
+double
+RoutingEnergyModel::GetTotalEnergyConsumption (void) const
+{
+  return 0.0;
+}
+
+void
+RoutingEnergyModel::ChangeState (int newState)
+{
+}
+
+void
+RoutingEnergyModel::HandleEnergyDepletion (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_depletionCallback.IsNull ())
+    {
+      m_depletionCallback ();
+    }
+}
+
+void
+RoutingEnergyModel::HandleEnergyRecharged (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_rechargedCallback.IsNull ())
+    {
+      m_rechargedCallback ();
+    }
+}
+
+void
+RoutingEnergyModel::DoDispose (void)
+{
+  m_source = 0;
+  m_depletionCallback = MakeNullCallback<void> ();
+  m_rechargedCallback = MakeNullCallback<void> ();
+  DeviceEnergyModel::DoDispose ();
+}
+
+}
+}
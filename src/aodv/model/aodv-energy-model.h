@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_ENERGY_MODEL_H
+#define AODV_ENERGY_MODEL_H
+
+#include "ns3/device-energy-model.h"
+#include "ns3/energy-source.h"
+#include "ns3/callback.h"
+
+namespace ns3
+{
+namespace aodv
+{
+/**
+ * \ingroup aodv
+ * \brief Connects RoutingProtocol to the energy source of its node.
+ *
+ * The model draws no current: the energy spent to send and receive routing
+ * messages is accounted by the device energy models of the radio. It only
+ * forwards depletion and recharge notifications of the source to the
+ * routing protocol.
+ */
+class RoutingEnergyModel : public DeviceEnergyModel
+{
+public:
+  static TypeId GetTypeId (void);
+  RoutingEnergyModel ();
+  virtual ~RoutingEnergyModel ();
+
+  virtual void SetEnergySource (Ptr<EnergySource> source);
+  /// Return the energy source this model is attached to
+  Ptr<EnergySource> GetEnergySource (void) const { return m_source; }
+  /// No energy is consumed by the model itself
+  virtual double GetTotalEnergyConsumption (void) const;
+  /// The model has no states
+  virtual void ChangeState (int newState);
+  virtual void HandleEnergyDepletion (void);
+  virtual void HandleEnergyRecharged (void);
+
+  /// Set callback invoked when the energy source is drained
+  void SetEnergyDepletionCallback (Callback<void> cb) { m_depletionCallback = cb; }
+  /// Set callback invoked when the energy source is recharged
+  void SetEnergyRechargedCallback (Callback<void> cb) { m_rechargedCallback = cb; }
+
+private:
+  virtual void DoDispose (void);
+
+  Ptr<EnergySource> m_source;
+  Callback<void> m_depletionCallback;
+  Callback<void> m_rechargedCallback;
+};
+
+}
+}
+
+#endif /* AODV_ENERGY_MODEL_H */
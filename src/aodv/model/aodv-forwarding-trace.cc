@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-forwarding-trace.h"
+#include "ns3/abort.h"
+#include <cstdio>
+#include <cstring>
+
+namespace ns3
+{
+namespace aodv
+{
+
+ForwardingTraceSink::ForwardingTraceSink (std::string filename, enum Format format, uint32_t capacity)
+  : m_format (format),
+    m_buffer (capacity),
+    m_size (0),
+    m_records (0)
+{
+  NS_ABORT_MSG_UNLESS (capacity > 0, "Forwarding trace buffer can not be empty");
+  std::ios_base::openmode mode = std::ios_base::out | std::ios_base::trunc;
+  if (format == BINARY)
+    {
+      mode |= std::ios_base::binary;
+    }
+  m_file.open (filename.c_str (), mode);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Unable to open forwarding trace file " << filename);
+}
+
+ForwardingTraceSink::~ForwardingTraceSink ()
+{
+  Flush ();
+}
+
+void
+ForwardingTraceSink::Record (ForwardingRecord const & record)
+{
+  m_buffer[m_size++] = record;
+  ++m_records;
+  if (m_size == m_buffer.size ())
+    {
+      Flush ();
+    }
+}
+
+void
+ForwardingTraceSink::Flush ()
+{
+  if (m_size == 0)
+    {
+      return;
+    }
+  m_block.clear ();
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      if (m_format == BINARY)
+        {
+          WriteBinary (m_buffer[i]);
+        }
+      else
+        {
+          WriteCsv (m_buffer[i]);
+        }
+    }
+  m_file.write (&m_block[0], m_block.size ());
+  m_file.flush ();
+  m_size = 0;
+}
+
+void
+ForwardingTraceSink::WriteCsv (ForwardingRecord const & r)
+{
+  char line[160];
+  uint32_t a = r.address.Get ();
+  uint32_t p = r.previousHop.Get ();
+  uint32_t n = r.nextHop.Get ();
+  uint32_t d = r.destination.Get ();
+  int len = snprintf (line, sizeof (line),
+                      "%lld,%u,%u.%u.%u.%u,%u.%u.%u.%u,%u.%u.%u.%u,%u.%u.%u.%u,%u,%.7g,%u\n",
+                      (long long) r.time.GetNanoSeconds (), r.node,
+                      a >> 24, (a >> 16) & 0xff, (a >> 8) & 0xff, a & 0xff,
+                      p >> 24, (p >> 16) & 0xff, (p >> 8) & 0xff, p & 0xff,
+                      n >> 24, (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff,
+                      d >> 24, (d >> 16) & 0xff, (d >> 8) & 0xff, d & 0xff,
+                      r.energy, r.qValue, r.neighbors);
+  m_block.insert (m_block.end (), line, line + len);
+}
+
+void
+ForwardingTraceSink::WriteBinary (ForwardingRecord const & r)
+{
+  uint32_t q;
+  std::memcpy (&q, &r.qValue, sizeof (q));
+  uint64_t t = r.time.GetNanoSeconds ();
+  uint32_t words[8] = { r.node, r.address.Get (), r.previousHop.Get (), r.nextHop.Get (),
+                        r.destination.Get (), r.energy, q, r.neighbors };
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      m_block.push_back (t & 0xff);
+      t >>= 8;
+    }
+  for (uint32_t w = 0; w < 8; ++w)
+    {
+      for (uint32_t i = 0; i < 4; ++i)
+        {
+          m_block.push_back ((words[w] >> (8 * i)) & 0xff);
+        }
+    }
+}
+
+}
+}
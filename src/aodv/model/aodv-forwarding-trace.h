@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_FORWARDING_TRACE_H
+#define AODV_FORWARDING_TRACE_H
+
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/simple-ref-count.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace aodv
+{
+/**
+ * \ingroup aodv
+ * \brief Next hop decision of RoutingProtocol::Forwarding
+ */
+struct ForwardingRecord
+{
+  Time time;                  ///< Time of the decision
+  uint32_t node;              ///< Id of the forwarding node
+  Ipv4Address address;        ///< Address of the forwarding node
+  Ipv4Address previousHop;    ///< Node the packet came from
+  Ipv4Address nextHop;        ///< Chosen next hop
+  Ipv4Address destination;    ///< Destination of the packet
+  uint32_t energy;            ///< Residual energy of the forwarding node
+  float qValue;               ///< Q-value of the chosen next hop
+  uint32_t neighbors;         ///< Number of neighbors the next hop was chosen from
+};
+
+/**
+ * \ingroup aodv
+ * \brief Buffered file sink for the Forward trace source of RoutingProtocol.
+ *
+ * Records are copied into a preallocated buffer and written in one block
+ * when the buffer is full, on Flush () and on destruction, so the simulation
+ * does not format or write anything per forwarded packet.
+ *
+ * In the CSV format every record is a line
+ * time_ns,node,address,previous_hop,next_hop,destination,energy,q_value,neighbors.
+ * In the binary format it is a 40 byte little-endian block with the same
+ * fields: int64 time in ns, uint32 node, four IPv4 addresses in host order
+ * as uint32, uint32 energy, IEEE 754 float q_value and uint32 neighbors.
+ */
+class ForwardingTraceSink : public SimpleRefCount<ForwardingTraceSink>
+{
+public:
+  /// File format
+  enum Format
+  {
+    CSV,
+    BINARY
+  };
+  /**
+   * \param filename file to write, truncated if it exists
+   * \param format file format
+   * \param capacity number of records buffered between two writes
+   */
+  ForwardingTraceSink (std::string filename, enum Format format = CSV, uint32_t capacity = 4096);
+  ~ForwardingTraceSink ();
+  /// Buffer record, write the buffer if it is full
+  void Record (ForwardingRecord const & record);
+  /// Write all buffered records
+  void Flush ();
+  /// Return number of records received so far
+  uint64_t GetRecords () const { return m_records; }
+
+private:
+  ForwardingTraceSink (ForwardingTraceSink const &);
+  ForwardingTraceSink & operator= (ForwardingTraceSink const &);
+  /// Append the CSV line of record to m_block
+  void WriteCsv (ForwardingRecord const & record);
+  /// Append the binary block of record to m_block
+  void WriteBinary (ForwardingRecord const & record);
+
+  std::ofstream m_file;
+  enum Format m_format;
+  /// Buffered records, m_size of them are valid
+  std::vector<ForwardingRecord> m_buffer;
+  uint32_t m_size;
+  /// Serialized records of the current Flush
+  std::vector<char> m_block;
+  uint64_t m_records;
+};
+
+}
+}
+
+#endif /* AODV_FORWARDING_TRACE_H */
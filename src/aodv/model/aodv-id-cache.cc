@@ -26,38 +26,194 @@
  *          Pavel Boyko <boyko@iitp.ru>
  */
 #include "aodv-id-cache.h"
+#include "ns3/hash.h"
+#include "ns3/abort.h"
 #include <algorithm>
+#include <cmath>
 
 namespace ns3
 {
 namespace aodv
 {
+
+/// Approximate size of an EXACT entry: a tree node in m_idCache and one in m_expiry
+static const uint32_t ENTRY_BYTES = 2 * (4 * sizeof (void *) + sizeof (Time) + sizeof (std::pair<Ipv4Address, uint32_t>));
+
+IdCache::IdCache (Time lifetime)
+  : m_lifetime (lifetime),
+    m_mode (EXACT),
+    m_capacity (0),
+    m_current (0),
+    m_bits (0),
+    m_hashes (0),
+    m_lookups (0),
+    m_hits (0)
+{
+  m_inserted[0] = m_inserted[1] = 0;
+}
+
 bool
 IdCache::IsDuplicate (Ipv4Address addr, uint32_t id)
 {
+  ++m_lookups;
+  if (m_mode == BLOOM)
+    {
+      bool duplicate = IsDuplicateBloom (addr, id);
+      m_hits += duplicate;
+      return duplicate;
+    }
   Purge ();
-  for (std::vector<UniqueId>::const_iterator i = m_idCache.begin ();
-       i != m_idCache.end (); ++i)
-    if (i->m_context == addr && i->m_id == id)
+  UniqueId uniqueId (addr, id);
+  std::map<UniqueId, Time>::const_iterator i = m_idCache.find (uniqueId);
+  if (i != m_idCache.end ())
+    {
+      ++m_hits;
       return true;
-  struct UniqueId uniqueId =
-  { addr, id, m_lifetime + Simulator::Now () };
-  m_idCache.push_back (uniqueId);
+    }
+  if (m_capacity != 0 && m_idCache.size () >= m_capacity)
+    {
+      m_idCache.erase (m_expiry.begin ()->second);
+      m_expiry.erase (m_expiry.begin ());
+    }
+  Time expire = m_lifetime + Simulator::Now ();
+  m_idCache.insert (std::make_pair (uniqueId, expire));
+  m_expiry.insert (std::make_pair (expire, uniqueId));
   return false;
 }
+
 void
 IdCache::Purge ()
 {
-  m_idCache.erase (remove_if (m_idCache.begin (), m_idCache.end (),
-                              IsExpired ()), m_idCache.end ());
+  if (m_mode == BLOOM)
+    {
+      Rotate ();
+      return;
+    }
+  // m_expiry is ordered by expire time, so only expired entries are visited
+  Time now = Simulator::Now ();
+  std::set<std::pair<Time, UniqueId> >::iterator i = m_expiry.begin ();
+  for (; i != m_expiry.end () && i->first < now; ++i)
+    {
+      m_idCache.erase (i->second);
+    }
+  m_expiry.erase (m_expiry.begin (), i);
+}
+
+void
+IdCache::SetLifetime (Time lifetime)
+{
+  // The current Bloom filter receives IDs from one lifetime before m_rotate
+  m_rotate += lifetime - m_lifetime;
+  m_lifetime = lifetime;
 }
 
 uint32_t
 IdCache::GetSize ()
 {
   Purge ();
+  if (m_mode == BLOOM)
+    return m_inserted[0] + m_inserted[1];
   return m_idCache.size ();
 }
 
+void
+IdCache::SetMode (enum Mode mode, uint32_t capacity, double falsePositiveRate)
+{
+  m_mode = mode;
+  m_capacity = capacity;
+  m_idCache.clear ();
+  m_expiry.clear ();
+  m_filter[0].clear ();
+  m_filter[1].clear ();
+  m_inserted[0] = m_inserted[1] = 0;
+  if (mode == EXACT)
+    return;
+
+  NS_ABORT_MSG_UNLESS (falsePositiveRate > 0 && falsePositiveRate < 1, "False positive rate must be in (0, 1)");
+  double ids = (capacity == 0) ? 1024 : capacity;
+  // Optimal Bloom filter for ids entries: bits = -n ln p / ln^2 2, hashes = bits / n ln 2
+  double bits = std::ceil (-ids * std::log (falsePositiveRate) / (std::log (2.0) * std::log (2.0)));
+  uint32_t words = std::max (1.0, std::ceil (bits / 64));
+  m_bits = words * 64;
+  m_hashes = std::max (1.0, std::floor (m_bits / ids * std::log (2.0) + 0.5));
+  m_filter[0].resize (words, 0);
+  m_filter[1].resize (words, 0);
+  m_current = 0;
+  m_rotate = Simulator::Now () + m_lifetime;
+}
+
+IdCache::Stats
+IdCache::GetStats () const
+{
+  Stats stats;
+  stats.lookups = m_lookups;
+  stats.hits = m_hits;
+  if (m_mode == BLOOM)
+    {
+      stats.entries = m_inserted[0] + m_inserted[1];
+      stats.bytes = 2 * m_filter[0].size () * sizeof (uint64_t);
+    }
+  else
+    {
+      stats.entries = m_idCache.size ();
+      stats.bytes = m_idCache.size () * ENTRY_BYTES;
+    }
+  return stats;
+}
+
+void
+IdCache::Rotate ()
+{
+  Time now = Simulator::Now ();
+  if (now < m_rotate)
+    return;
+  if (now >= m_rotate + m_lifetime)
+    {
+      // Both filters are out of date
+      std::fill (m_filter[m_current].begin (), m_filter[m_current].end (), 0);
+      m_inserted[m_current] = 0;
+      m_rotate = now;
+    }
+  m_current ^= 1;
+  std::fill (m_filter[m_current].begin (), m_filter[m_current].end (), 0);
+  m_inserted[m_current] = 0;
+  m_rotate += m_lifetime;
+}
+
+bool
+IdCache::IsDuplicateBloom (Ipv4Address addr, uint32_t id)
+{
+  Rotate ();
+  uint8_t key[8];
+  addr.Serialize (key);
+  key[4] = id >> 24;
+  key[5] = id >> 16;
+  key[6] = id >> 8;
+  key[7] = id;
+  // Double hashing: bit i is h1 + i * h2
+  uint64_t hash = Hash64 (reinterpret_cast<char const *> (key), sizeof (key));
+  uint32_t h1 = hash;
+  uint32_t h2 = (hash >> 32) | 1;
+  uint32_t other = m_current ^ 1;
+  bool inCurrent = true;
+  bool inOther = true;
+  for (uint32_t i = 0; i < m_hashes; ++i)
+    {
+      uint32_t bit = (h1 + i * h2) % m_bits;
+      uint64_t mask = (uint64_t) 1 << (bit % 64);
+      inCurrent = inCurrent && (m_filter[m_current][bit / 64] & mask);
+      inOther = inOther && (m_filter[other][bit / 64] & mask);
+    }
+  if (inCurrent || inOther)
+    return true;
+  for (uint32_t i = 0; i < m_hashes; ++i)
+    {
+      uint32_t bit = (h1 + i * h2) % m_bits;
+      m_filter[m_current][bit / 64] |= (uint64_t) 1 << (bit % 64);
+    }
+  ++m_inserted[m_current];
+  return false;
+}
+
 }
 }
@@ -31,6 +31,8 @@
 
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
+#include <map>
+#include <set>
 #include <vector>
 
 namespace ns3
@@ -41,44 +43,93 @@ namespace aodv
  * \ingroup aodv
  * 
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * In EXACT mode IDs are kept until they expire, indexed by ID and by
+ * expiry time. In BLOOM mode IDs are remembered by two Bloom filters
+ * rotated every lifetime: memory is fixed, an ID is remembered for between
+ * one and two lifetimes and unknown IDs may be reported as duplicates.
  */
 class IdCache
 {
 public:
+  /// How IDs are remembered
+  enum Mode
+  {
+    EXACT, ///< keep every ID until it expires
+    BLOOM  ///< rotating Bloom filters of bounded size
+  };
+  /// Cache statistics
+  struct Stats
+  {
+    /// Number of IsDuplicate calls
+    uint64_t lookups;
+    /// Number of IsDuplicate calls that found a duplicate
+    uint64_t hits;
+    /// IDs in the cache, including expired ones not purged yet
+    uint32_t entries;
+    /// Approximate memory used to store the IDs, in bytes
+    uint32_t bytes;
+  };
   /// c-tor
-  IdCache (Time lifetime) : m_lifetime (lifetime) {}
+  IdCache (Time lifetime);
   /// Check that entry (addr, id) exists in cache. Add entry, if it doesn't exist.
   bool IsDuplicate (Ipv4Address addr, uint32_t id);
   /// Remove all expired entries
   void Purge ();
   /// Return number of entries in cache
   uint32_t GetSize ();
-  /// Set lifetime for future added entries.
-  void SetLifetime (Time lifetime) { m_lifetime = lifetime; }
+  /// Set lifetime for future added entries, and the rotation period of the Bloom filters.
+  void SetLifetime (Time lifetime);
   /// Return lifetime for existing entries in cache
   Time GetLifeTime () const { return m_lifetime; }
+  /**
+   * Select how IDs are remembered, the cache is emptied.
+   *
+   * \param mode EXACT or BLOOM
+   * \param capacity in EXACT mode, maximum number of entries, the one
+   *        closest to expiry makes room for a new one; 0 for no limit. In
+   *        BLOOM mode, number of IDs expected per lifetime; 0 for 1024
+   * \param falsePositiveRate BLOOM mode only, rate of unknown IDs reported
+   *        as duplicates when capacity IDs are stored in a filter
+   */
+  void SetMode (enum Mode mode, uint32_t capacity, double falsePositiveRate);
+  /// Return how IDs are remembered
+  enum Mode GetMode () const { return m_mode; }
+  /// Return lookup counters and memory use
+  Stats GetStats () const;
 private:
-  /// Unique packet ID
-  struct UniqueId
-  {
-    /// ID is supposed to be unique in single address context (e.g. sender address)
-    Ipv4Address m_context;
-    /// The id
-    uint32_t m_id;
-    /// When record will expire
-    Time m_expire;
-  };
-  struct IsExpired
-  {
-    bool operator() (const struct UniqueId & u) const
-    {
-      return (u.m_expire < Simulator::Now ());
-    }
-  };
-  /// Already seen IDs
-  std::vector<UniqueId> m_idCache;
+  /// ID is supposed to be unique in single address context (e.g. sender address)
+  typedef std::pair<Ipv4Address, uint32_t> UniqueId;
+  /// Expire time of the entries
+  std::map<UniqueId, Time> m_idCache;
+  /// Entries ordered by expire time
+  std::set<std::pair<Time, UniqueId> > m_expiry;
   /// Default lifetime for ID records
   Time m_lifetime;
+  /// How IDs are remembered
+  enum Mode m_mode;
+  /// Maximum number of entries in EXACT mode, 0 for no limit
+  uint32_t m_capacity;
+  /// Bloom filters, m_filter[m_current] receives new IDs
+  std::vector<uint64_t> m_filter[2];
+  /// Number of IDs added to each Bloom filter
+  uint32_t m_inserted[2];
+  /// Index of the Bloom filter receiving new IDs
+  uint32_t m_current;
+  /// Number of bits of a Bloom filter
+  uint32_t m_bits;
+  /// Number of bits set per ID
+  uint32_t m_hashes;
+  /// When the Bloom filters rotate next
+  Time m_rotate;
+  /// Statistics counters
+  uint64_t m_lookups;
+  uint64_t m_hits;
+
+  /// Rotate the Bloom filters if their time is over
+  void Rotate ();
+  /// Check ID in the Bloom filters, add it to the current one if unknown
+  bool IsDuplicateBloom (Ipv4Address addr, uint32_t id);
 };
 
 }
@@ -43,7 +43,14 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighbors");
 namespace aodv
 {
 Neighbors::Neighbors (Time delay) : 
-  m_ntimer (Timer::CANCEL_ON_DESTROY)
+  m_ntimer (Timer::CANCEL_ON_DESTROY),
+  m_nextOrder (0),
+  m_decisionOffset (0),
+  m_decided (false),
+  m_policyVersion (0),
+  m_defaultPolicy (0),
+  mns_energy (0),
+  m_energySum (0)
 {
   m_ntimer.SetDelay (delay);
   m_ntimer.SetFunction (&Neighbors::Purge, this);
@@ -54,50 +61,50 @@ bool
 Neighbors::IsNeighbor (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin ();
-       i != m_nb.end (); ++i)
-    {
-      if (i->m_neighborAddress == addr)
-        return true;
-    }
-  return false;
+  return (m_ipIndex.find (addr) != m_ipIndex.end ());
 }
 
 Time
 Neighbors::GetExpireTime (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin (); i
-       != m_nb.end (); ++i)
-    {
-      if (i->m_neighborAddress == addr)
-        return (i->m_expireTime - Simulator::Now ());
-    }
+  Neighbor * nb = Find (addr);
+  if (nb != 0)
+    return (nb->m_expireTime - Simulator::Now ());
   return Seconds (0);
 }
 //New
 std::vector<Neighbors::Neighbor>
 Neighbors::GetNeighborsList (void) {
-  return m_nb;
+  CheckPolicy ();
+  std::vector<Neighbor> list (m_nb);
+  for (std::vector<Neighbor>::iterator i = list.begin (); i != list.end (); ++i)
+    {
+      i->q_value = GetQValue (*i);
+    }
+  return list;
 }
 
 void
 Neighbors::Update (Ipv4Address addr, Time expire)
 {
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
-    if (i->m_neighborAddress == addr)
-      {
-        i->timestamp = Simulator::Now();
-        i->m_expireTime
-          = std::max (expire + Simulator::Now (), i->m_expireTime);
-        if (i->m_hardwareAddress == Mac48Address ())
-          i->m_hardwareAddress = LookupMacAddress (i->m_neighborAddress);
-        return;
-      }
+  Neighbor * nb = Find (addr);
+  if (nb != 0)
+    {
+      nb->timestamp = Simulator::Now ();
+      Rerank (*nb);
+      ExtendExpireTime (*nb, expire + Simulator::Now ());
+      if (nb->m_hardwareAddress == Mac48Address ())
+        {
+          nb->m_hardwareAddress = LookupMacAddress (nb->m_neighborAddress);
+          IndexMacAddress (*nb);
+        }
+      return;
+    }
 
   NS_LOG_LOGIC ("Open link to " << addr);
   Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
-  m_nb.push_back (neighbor);
+  Insert (neighbor);
   Purge ();
 }
 
@@ -107,21 +114,24 @@ Neighbors::Update (Ipv4Address addr, Time expire, uint32_t me, float mv, uint32_
 {
   // NS_LOG_UNCOND("Neighbor: " << addr << "\tEnergy: " << me << "\tNeighbor Aver: " << mns_e);
   // NS_LOG_UNCOND("INVOKED" << me << "\t" << mns_e);
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
-    if (i->m_neighborAddress == addr)
-      {
-        i->m_energy = me; i->m_queuelength = mql; i->v_value = mv; i->mns_energy = mns_e;
-        i->timestamp = Simulator::Now();
-        i->m_expireTime
-          = std::max (expire + Simulator::Now (), i->m_expireTime);
-        if (i->m_hardwareAddress == Mac48Address ()) {
-          i->m_hardwareAddress = LookupMacAddress (i->m_neighborAddress);
+  Neighbor * nb = Find (addr);
+  if (nb != 0)
+    {
+      m_energySum += me - nb->m_energy;
+      nb->m_energy = me; nb->m_queuelength = mql; nb->v_value = mv; nb->mns_energy = mns_e;
+      nb->timestamp = Simulator::Now ();
+      Rerank (*nb);
+      ExtendExpireTime (*nb, expire + Simulator::Now ());
+      if (nb->m_hardwareAddress == Mac48Address ())
+        {
+          nb->m_hardwareAddress = LookupMacAddress (nb->m_neighborAddress);
+          IndexMacAddress (*nb);
         }
-        return;
-      }
+      return;
+    }
   NS_LOG_LOGIC ("Open link to " << addr);
   Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now (), me,mv, mql,mns_e);
-  m_nb.push_back (neighbor);
+  Insert (neighbor);
   Purge ();
 }
 
@@ -135,6 +145,7 @@ void Neighbors::VValueUpdate(void) {
   for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i) {
     i->v_value = 0.0;
   }
+  RerankAll ();
 
 }
 
@@ -143,61 +154,157 @@ std::string Neighbors::PrintOut(void) const {
   Time n = Simulator::Now();
   for (uint32_t index = 0; index<m_nb.size(); index++) {
     m_nb.at(index).m_neighborAddress.Print(ss);
-    ss << "\tEnergy:" << m_nb.at(index).m_energy <<"\tAverE:"<<m_nb.at(index).mns_energy<<"\tQ value:"<<(m_nb.at(index).q_value)<<"\t Exp. Time"<<m_nb.at(index).m_expireTime-n<<std::endl;
+    ss << "\tEnergy:" << m_nb.at(index).m_energy <<"\tAverE:"<<m_nb.at(index).mns_energy<<"\tQ value:"<<GetQValue (m_nb.at(index))<<"\t Exp. Time"<<m_nb.at(index).m_expireTime-n<<std::endl;
   }
   return ss.str();
 
 }
 
+/*
+ * The Q-value of a neighbor is Score (i) + offset. Score only changes when a
+ * hello from i is received and the offset (own energy, own V value, current
+ * time) is the same for every neighbor, see RewardPolicy. m_ranking therefore
+ * stays ordered by Q-value without any periodic recomputation.
+ */
+void
+Neighbors::SetRewardPolicy (Ptr<RewardPolicy> policy)
+{
+  NS_ASSERT (policy != 0);
+  m_policy = policy;
+  m_policyVersion = policy->GetVersion ();
+  m_defaultPolicy = 0;
+  if (policy->GetInstanceTypeId () == DefaultRewardPolicy::GetTypeId ())
+    {
+      m_defaultPolicy = PeekPointer (DynamicCast<DefaultRewardPolicy> (policy));
+    }
+  m_decided = false;
+  RerankAll ();
+}
+
+void
+Neighbors::CheckPolicy ()
+{
+  if (m_policy == 0)
+    {
+      SetRewardPolicy (CreateObject<DefaultRewardPolicy> ());
+    }
+  else if (m_policy->GetVersion () != m_policyVersion)
+    {
+      m_policyVersion = m_policy->GetVersion ();
+      m_decided = false;
+      RerankAll ();
+    }
+}
+
+double
+Neighbors::Score (Neighbor const & nb) const
+{
+  if (m_defaultPolicy != 0)
+    {
+      return m_defaultPolicy->DefaultRewardPolicy::Score (nb.m_energy, nb.mns_energy, nb.v_value, nb.timestamp);
+    }
+  return m_policy->Score (nb.m_energy, nb.mns_energy, nb.v_value, nb.timestamp);
+}
+
+void
+Neighbors::Rerank (Neighbor & nb)
+{
+  CheckPolicy ();
+  m_ranking.erase (Rank (nb));
+  nb.m_score = Score (nb);
+  m_ranking.insert (Rank (nb));
+}
+
+void
+Neighbors::RerankAll ()
+{
+  // One n log n sort, then every rank is appended to m_ranking with an end
+  // hint in amortized constant time, instead of a tree erase and insert for
+  // every entry.
+  std::vector<Rank> ranks;
+  ranks.reserve (m_nb.size ());
+  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+    {
+      i->m_score = Score (*i);
+      ranks.push_back (Rank (*i));
+    }
+  std::sort (ranks.begin (), ranks.end ());
+  m_ranking.clear ();
+  for (std::vector<Rank>::const_iterator i = ranks.begin (); i != ranks.end (); ++i)
+    {
+      m_ranking.insert (m_ranking.end (), *i);
+    }
+}
+
+float
+Neighbors::GetQValue (Neighbor const & nb) const
+{
+  if (!m_decided)
+    return nb.q_value;
+  if (nb.m_neighborAddress == m_decisionPreHop || nb.m_neighborAddress == Ipv4Address ("10.1.1.1"))
+    return -1000000;
+  if (nb.m_neighborAddress == m_decisionDst)
+    return 0;
+  return nb.m_score + m_decisionOffset;
+}
+
 Ipv4Address Neighbors::RouteDecision(Ptr<Node> nd,const Ipv4Address & preHop, const Ipv4Address & dst) {
-  uint32_t se = nd->GetSelfEnergy();
+  return RouteDecision (nd, nd->GetSelfEnergy (), preHop, dst);
+}
+
+Ipv4Address Neighbors::RouteDecision(Ptr<Node> nd, uint32_t se, const Ipv4Address & preHop, const Ipv4Address & dst) {
+  if (m_nb.empty ())
+    {
+      NS_LOG_LOGIC ("No neighbor to route through");
+      return Ipv4Address ();
+    }
+  CheckPolicy ();
   float sv = nd->GetSelfV_value();
-  float nmax = 0.0;
-  uint32_t idx = 0;
   Ipv4Address sr = Ipv4Address("10.1.1.1");
-  //Logic problem
-  for(uint32_t index=0; index<m_nb.size();index++ ) {
-    Neighbors::Neighbor &cr = m_nb.at(index);
-    Time cu = Simulator::Now() - cr.timestamp ;
-    if(cr.m_neighborAddress.IsEqual(preHop)||cr.m_neighborAddress.IsEqual(sr)) {
-      cr.q_value = -1000000;
-      continue;
-    }
-    else {
-      if(cr.m_neighborAddress.IsEqual(dst)) {
-        cr.q_value = 0;
-        continue;
-      }
-      // NS_LOG_UNCOND(cu);
-      float r_t = 0.9*(-1.0+0.5*cr.m_energy/1000000.0+0.5*2.0/3.1415927*atan((float)(cr.m_energy-cr.mns_energy)/1000000.0)+0.5*(-1.0/50.0*cu.GetMilliSeconds()))+0.1*(-1.0+0.5*se/1000000.0+0.5*2.0/3.1415927*atan((float)(se-mns_energy)/1000000.0)-0.5*0.8);
-      cr.q_value = r_t + 0.9*(0.7*cr.v_value+0.3*sv);
+  m_decided = true;
+  m_decisionPreHop = preHop;
+  m_decisionDst = dst;
+  if (m_defaultPolicy != 0)
+    m_decisionOffset = m_defaultPolicy->DefaultRewardPolicy::Offset (se, mns_energy, sv, Simulator::Now ());
+  else
+    m_decisionOffset = m_policy->Offset (se, mns_energy, sv, Simulator::Now ());
+
+  if (m_nb.size () == 1)
+    {
+      NS_LOG_UNCOND("Only ONE");
+      nd->SetSelfV_value(0.0);
+      return m_nb.front ().m_neighborAddress;
     }
-  }
 
-  for (uint32_t index = 0; index<m_nb.size(); index++) {
-    Neighbors::Neighbor &cr = m_nb.at(index);
-    if(m_nb.size()==1 ) {
-      NS_LOG_UNCOND("Only ONE");
-      idx = 0;
+  // The previous hop and the source score -1000000 and the destination 0,
+  // all other neighbors compete with their ranked Q-value. Equal Q-values
+  // go to the neighbor known for the longest time.
+  Neighbor const * best = 0;
+  float nmax = 0.0;
+  for (std::set<Rank>::const_iterator i = m_ranking.begin (); i != m_ranking.end (); ++i)
+    {
+      if (i->address == preHop || i->address == sr || i->address == dst)
+        continue;
+      best = &m_nb[m_ipIndex[i->address]];
+      nmax = i->score + m_decisionOffset;
       break;
     }
-    if(index==0) {
-      nmax = cr.q_value; continue;
-    }
-    else {
-      if(cr.q_value>nmax) {
-        nmax=cr.q_value;
-        idx=index;
-      }
+  Neighbor const * excluded[3] = { Find (dst), Find (preHop), Find (sr) };
+  for (uint32_t k = 0; k < 3; ++k)
+    {
+      Neighbor const * cr = excluded[k];
+      if (cr == 0)
+        continue;
+      float q = GetQValue (*cr);
+      if (best == 0 || q > nmax || (q == nmax && cr->m_order < best->m_order))
+        {
+          best = cr;
+          nmax = q;
+        }
     }
-  }
 
   nd->SetSelfV_value(nmax);
-  // NS_LOG_UNCOND(nmax);
-  return m_nb.at(idx).m_neighborAddress;
-
-  // Neighbors::Neighbor* n_max;
-
+  return best->m_neighborAddress;
 }
 
 uint32_t Neighbors::GetMnsEnergy(void) {
@@ -209,44 +316,136 @@ uint32_t Neighbors::GetMnsEnergy(void) {
 void Neighbors::mns_gen() {
   if(m_nb.size()==0)
   mns_energy = 0.0;
-  else {
-    uint32_t averE = 0;
-    for(uint32_t index=0;index<m_nb.size();index++) {
-      averE+=m_nb.at(index).m_energy;
+  else
+  mns_energy = m_energySum / m_nb.size ();
+}
+
+void
+Neighbors::Purge ()
+{
+  if (m_nb.empty ())
+    return;
+
+  // m_expiry is ordered by expire time, so only expired entries are visited
+  std::vector<uint32_t> slots;
+  Time now = Simulator::Now ();
+  for (std::set<std::pair<Time, Ipv4Address> >::const_iterator i = m_expiry.begin ();
+       i != m_expiry.end () && i->first < now; ++i)
+    {
+      slots.push_back (m_ipIndex[i->second]);
     }
-    mns_energy = (uint32_t)(averE/m_nb.size());
-  }
+  Remove (slots);
+  m_ntimer.Cancel ();
+  m_ntimer.Schedule ();
 }
 
-struct CloseNeighbor
+void
+Neighbors::Clear ()
 {
-  bool operator() (const Neighbors::Neighbor & nb) const
-  {
-    return ((nb.m_expireTime < Simulator::Now ()) || nb.close);
-  }
-};
+  m_nb.clear ();
+  m_ipIndex.clear ();
+  m_macIndex.clear ();
+  m_expiry.clear ();
+  m_ranking.clear ();
+  m_energySum = 0;
+}
+
+Neighbors::Neighbor *
+Neighbors::Find (Ipv4Address addr)
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_ipIndex.find (addr);
+  if (i == m_ipIndex.end ())
+    return 0;
+  return &m_nb[i->second];
+}
 
 void
-Neighbors::Purge ()
+Neighbors::ExtendExpireTime (Neighbor & nb, Time expire)
 {
-  if (m_nb.empty ())
+  if (expire <= nb.m_expireTime)
+    return;
+  m_expiry.erase (std::make_pair (nb.m_expireTime, nb.m_neighborAddress));
+  nb.m_expireTime = expire;
+  m_expiry.insert (std::make_pair (nb.m_expireTime, nb.m_neighborAddress));
+}
+
+void
+Neighbors::IndexMacAddress (Neighbor const & nb)
+{
+  if (nb.m_hardwareAddress == Mac48Address ())
     return;
+  m_macIndex.insert (std::make_pair (nb.m_hardwareAddress, nb.m_neighborAddress));
+}
+
+void
+Neighbors::Insert (Neighbor const & nb)
+{
+  CheckPolicy ();
+  m_ipIndex[nb.m_neighborAddress] = m_nb.size ();
+  m_expiry.insert (std::make_pair (nb.m_expireTime, nb.m_neighborAddress));
+  IndexMacAddress (nb);
+  m_nb.push_back (nb);
+  m_energySum += nb.m_energy;
+  Neighbor & entry = m_nb.back ();
+  entry.m_order = m_nextOrder++;
+  entry.m_score = Score (entry);
+  m_ranking.insert (Rank (entry));
+}
 
-  CloseNeighbor pred;
+void
+Neighbors::Remove (std::vector<uint32_t> const & slots)
+{
+  if (slots.empty ())
+    return;
+
+  std::vector<bool> dead (m_nb.size (), false);
+  for (std::vector<uint32_t>::const_iterator i = slots.begin (); i != slots.end (); ++i)
+    {
+      dead[*i] = true;
+    }
+  // Report link failures in list order, before any entry goes away
   if (!m_handleLinkFailure.IsNull ())
     {
-      for (std::vector<Neighbor>::iterator j = m_nb.begin (); j != m_nb.end (); ++j)
+      for (uint32_t j = 0; j < m_nb.size (); ++j)
         {
-          if (pred (*j))
+          if (dead[j])
             {
-              NS_LOG_LOGIC ("Close link to " << j->m_neighborAddress);
-              m_handleLinkFailure (j->m_neighborAddress);
+              NS_LOG_LOGIC ("Close link to " << m_nb[j].m_neighborAddress);
+              m_handleLinkFailure (m_nb[j].m_neighborAddress);
             }
         }
     }
-  m_nb.erase (std::remove_if (m_nb.begin (), m_nb.end (), pred), m_nb.end ());
-  m_ntimer.Cancel ();
-  m_ntimer.Schedule ();
+  // Compact m_nb keeping the order of survivors, renumber the moved ones
+  uint32_t k = 0;
+  for (uint32_t j = 0; j < m_nb.size (); ++j)
+    {
+      Neighbor const & nb = m_nb[j];
+      if (dead[j])
+        {
+          m_ipIndex.erase (nb.m_neighborAddress);
+          m_expiry.erase (std::make_pair (nb.m_expireTime, nb.m_neighborAddress));
+          m_ranking.erase (Rank (nb));
+          m_energySum -= nb.m_energy;
+          typedef std::multimap<Mac48Address, Ipv4Address>::iterator MacIterator;
+          std::pair<MacIterator, MacIterator> range = m_macIndex.equal_range (nb.m_hardwareAddress);
+          for (MacIterator m = range.first; m != range.second; ++m)
+            {
+              if (m->second == nb.m_neighborAddress)
+                {
+                  m_macIndex.erase (m);
+                  break;
+                }
+            }
+          continue;
+        }
+      if (k != j)
+        {
+          m_nb[k] = nb;
+          m_ipIndex[nb.m_neighborAddress] = k;
+        }
+      ++k;
+    }
+  m_nb.erase (m_nb.begin () + k, m_nb.end ());
 }
 
 void
@@ -290,13 +489,15 @@ Neighbors::ProcessTxError (WifiMacHeader const & hdr)
 {
   Mac48Address addr = hdr.GetAddr1 ();
 
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  typedef std::multimap<Mac48Address, Ipv4Address>::const_iterator MacIterator;
+  std::pair<MacIterator, MacIterator> range = m_macIndex.equal_range (addr);
+  std::vector<uint32_t> slots;
+  for (MacIterator i = range.first; i != range.second; ++i)
     {
-      if (i->m_hardwareAddress == addr)
-        i->close = true;
+      slots.push_back (m_ipIndex[i->second]);
     }
+  Remove (slots);
   Purge ();
 }
 }
 }
-
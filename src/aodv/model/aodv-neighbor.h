@@ -36,7 +36,10 @@
 #include "ns3/wifi-mac-header.h"
 #include "ns3/arp-cache.h"
 #include "ns3/node.h"
+#include "aodv-reward-policy.h"
 #include <vector>
+#include <map>
+#include <set>
 
 namespace ns3
 {
@@ -67,16 +70,24 @@ public:
     Time timestamp;
 
 
+    /// Neighbor dependent part of the Q-value, see Neighbors::Score
+    double m_score;
+    /// Insertion order of the entry, breaks ties between equal Q-values
+    uint64_t m_order;
+
+
     Neighbor (Ipv4Address ip, Mac48Address mac, Time t) :
       m_neighborAddress (ip), m_hardwareAddress (mac), m_expireTime (t),
-      close (false)
+      close (false), m_energy (0), v_value (0), m_queuelength (0), q_value (0),
+      mns_energy (0), m_score (0), m_order (0)
     {
       timestamp = Simulator::Now();
     }
     // New, Oct. 19
     Neighbor (Ipv4Address ip, Mac48Address mac, Time t, uint32_t me, float mv, uint32_t mql, uint32_t mns_e) :
     m_neighborAddress (ip), m_hardwareAddress (mac), m_expireTime (t),
-    close (false), m_energy (me), v_value(mv), m_queuelength (mql)
+    close (false), m_energy (me), v_value(mv), m_queuelength (mql),
+    m_score (0), m_order (0)
   {
     q_value = 0.0;
     mns_energy = mns_e;
@@ -93,15 +104,41 @@ public:
   // New, Oct. 18
   void Update (Ipv4Address addr, Time expire, uint32_t me, float mv, uint32_t mql, uint32_t mns_e);
   void VValueUpdate(void);
+  /**
+   * Choose the neighbor with the highest Q-value as next hop.
+   *
+   * Q-values are kept ranked as neighbors are updated, so the decision
+   * itself does not depend on the number of neighbors.
+   *
+   * \return the next hop, or Ipv4Address () if there is no neighbor
+   */
   Ipv4Address RouteDecision (Ptr<Node> nd,const Ipv4Address & preHop,const Ipv4Address & dst);
+  /// Same as above with the residual energy of nd given by the caller
+  Ipv4Address RouteDecision (Ptr<Node> nd, uint32_t energy, const Ipv4Address & preHop, const Ipv4Address & dst);
+  /**
+   * Use policy to compute Q-values. Entries are ranked again now, and again
+   * whenever the reward of policy changes, e.g. when one of its attributes
+   * is set.
+   */
+  void SetRewardPolicy (Ptr<RewardPolicy> policy);
+  /**
+   * Return the policy used to compute Q-values. A DefaultRewardPolicy is
+   * created when the first entry is added if none was set, before that the
+   * policy is 0.
+   */
+  Ptr<RewardPolicy> GetRewardPolicy () const { return m_policy; }
+  /// Set mns_energy to the mean energy of the neighbors
   void mns_gen(void);
+  /// Return the mean energy of the neighbors, kept up to date as entries change
   uint32_t GetMnsEnergy(void);
   /// Remove all expired entries
   void Purge ();
   /// Schedule m_ntimer.
   void ScheduleTimer ();
   /// Remove all entries
-  void Clear () { m_nb.clear (); }
+  void Clear ();
+  /// Return number of entries
+  uint32_t GetSize () const { return m_nb.size (); }
 
   /// Add ARP cache to be used to allow layer 2 notifications processing
   void AddArpCache (Ptr<ArpCache>);
@@ -123,15 +160,77 @@ private:
   Callback<void, WifiMacHeader const &> m_txErrorCallback;
   /// Timer for neighbor's list. Schedule Purge().
   Timer m_ntimer;
-  /// vector of entries
+  /// vector of entries, kept in insertion order
   std::vector<Neighbor> m_nb;
+  /// Position of every entry in m_nb, keyed by IP address
+  std::map<Ipv4Address, uint32_t> m_ipIndex;
+  /// IP addresses of entries with known hardware address, keyed by MAC
+  std::multimap<Mac48Address, Ipv4Address> m_macIndex;
+  /// (expire time, IP address) of every entry, earliest expiry first
+  std::set<std::pair<Time, Ipv4Address> > m_expiry;
+  /// Ranking of an entry by Q-value
+  struct Rank
+  {
+    double score;
+    uint64_t order;
+    Ipv4Address address;
+
+    Rank (Neighbor const & nb) :
+      score (nb.m_score), order (nb.m_order), address (nb.m_neighborAddress)
+    {
+    }
+    /// Highest score first, earliest inserted first among equal scores
+    bool operator< (Rank const & o) const
+    {
+      return (score > o.score) || (score == o.score && order < o.order);
+    }
+  };
+  /// All entries, best Q-value first
+  std::set<Rank> m_ranking;
+  /// Insertion order of the next new entry
+  uint64_t m_nextOrder;
+  /// Q-value offset common to all entries in the last RouteDecision
+  double m_decisionOffset;
+  /// Previous hop and destination of the last RouteDecision
+  Ipv4Address m_decisionPreHop;
+  Ipv4Address m_decisionDst;
+  /// true if RouteDecision has been called
+  bool m_decided;
+  /// Reward used to rank neighbors
+  Ptr<RewardPolicy> m_policy;
+  /// Version of m_policy when entries were last ranked
+  uint32_t m_policyVersion;
+  /// m_policy if it is exactly a DefaultRewardPolicy, called without virtual dispatch
+  DefaultRewardPolicy * m_defaultPolicy;
   /// Neighbor energy, aver.
   uint32_t mns_energy;
+  /// Sum of the energy of all entries, wraps around as the original loop did
+  uint32_t m_energySum;
   /// list of ARP cached to be used for layer 2 notifications processing
   std::vector<Ptr<ArpCache> > m_arp;
 
   /// Find MAC address by IP using list of ARP caches
   Mac48Address LookupMacAddress (Ipv4Address);
+  /// Return entry with address addr or 0 if there is no such entry
+  Neighbor * Find (Ipv4Address addr);
+  /// Move expire time of entry nb to max (expire, current expire time)
+  void ExtendExpireTime (Neighbor & nb, Time expire);
+  /// Add hardware address of nb to MAC index
+  void IndexMacAddress (Neighbor const & nb);
+  /// Append new entry to m_nb and all indexes
+  void Insert (Neighbor const & nb);
+  /// Remove entries from m_nb and all indexes, slots are sorted positions in m_nb
+  void Remove (std::vector<uint32_t> const & slots);
+  /// Part of the Q-value of nb that does not depend on this node or on the current time
+  double Score (Neighbor const & nb) const;
+  /// Recompute the score of nb and move it in m_ranking
+  void Rerank (Neighbor & nb);
+  /// Recompute the scores of all entries and rebuild m_ranking
+  void RerankAll ();
+  /// Create the default policy if none is set, rank again if the policy changed
+  void CheckPolicy ();
+  /// Q-value of nb in the last RouteDecision
+  float GetQValue (Neighbor const & nb) const;
   /// Process layer 2 TX error notification
   void ProcessTxError (WifiMacHeader const &);
 };
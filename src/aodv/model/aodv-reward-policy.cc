@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "aodv-reward-policy.h"
+#include "ns3/double.h"
+
+namespace ns3
+{
+namespace aodv
+{
+
+NS_OBJECT_ENSURE_REGISTERED (RewardPolicy);
+
+TypeId
+RewardPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::RewardPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+  ;
+  return tid;
+}
+
+RewardPolicy::RewardPolicy ()
+  : m_version (0)
+{
+}
+
+RewardPolicy::~RewardPolicy ()
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (DefaultRewardPolicy);
+
+TypeId
+DefaultRewardPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::DefaultRewardPolicy")
+    .SetParent<RewardPolicy> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<DefaultRewardPolicy> ()
+    .AddAttribute ("EnergyWeight", "Weight of the neighbor energy reward, this node gets the rest.",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&DefaultRewardPolicy::SetEnergyWeight,
+                                       &DefaultRewardPolicy::GetEnergyWeight),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("StalenessPenalty", "Reward lost per ms elapsed since the last hello of a neighbor.",
+                   DoubleValue (1.0 / 50.0),
+                   MakeDoubleAccessor (&DefaultRewardPolicy::SetStalenessPenalty,
+                                       &DefaultRewardPolicy::GetStalenessPenalty),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Discount", "Discount factor of the V values.",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&DefaultRewardPolicy::SetDiscount,
+                                       &DefaultRewardPolicy::GetDiscount),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("NeighborValueWeight", "Weight of the neighbor V value, the V value of this node gets the rest.",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&DefaultRewardPolicy::SetNeighborValueWeight,
+                                       &DefaultRewardPolicy::GetNeighborValueWeight),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+DefaultRewardPolicy::DefaultRewardPolicy ()
+  : m_energyWeight (0.9),
+    m_stalenessPenalty (1.0 / 50.0),
+    m_discount (0.9),
+    m_valueWeight (0.7)
+{
+  Update ();
+}
+
+void
+DefaultRewardPolicy::SetEnergyWeight (double weight)
+{
+  m_energyWeight = weight;
+  Update ();
+}
+
+double
+DefaultRewardPolicy::GetEnergyWeight (void) const
+{
+  return m_energyWeight;
+}
+
+void
+DefaultRewardPolicy::SetStalenessPenalty (double penalty)
+{
+  m_stalenessPenalty = penalty;
+  Update ();
+}
+
+double
+DefaultRewardPolicy::GetStalenessPenalty (void) const
+{
+  return m_stalenessPenalty;
+}
+
+void
+DefaultRewardPolicy::SetDiscount (double discount)
+{
+  m_discount = discount;
+  Update ();
+}
+
+double
+DefaultRewardPolicy::GetDiscount (void) const
+{
+  return m_discount;
+}
+
+void
+DefaultRewardPolicy::SetNeighborValueWeight (double weight)
+{
+  m_valueWeight = weight;
+  Update ();
+}
+
+double
+DefaultRewardPolicy::GetNeighborValueWeight (void) const
+{
+  return m_valueWeight;
+}
+
+void
+DefaultRewardPolicy::Update (void)
+{
+  m_neighborEnergyWeight = m_energyWeight;
+  m_selfEnergyWeight = 1.0 - m_energyWeight;
+  m_stalenessPerMs = m_energyWeight * 0.5 * m_stalenessPenalty;
+  m_neighborValueWeight = m_discount * m_valueWeight;
+  m_selfValueWeight = m_discount * (1.0 - m_valueWeight);
+  NotifyChanged ();
+}
+
+}
+}
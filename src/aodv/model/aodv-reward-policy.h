@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_REWARD_POLICY_H
+#define AODV_REWARD_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <cmath>
+
+namespace ns3
+{
+namespace aodv
+{
+/**
+ * \ingroup aodv
+ *
+ * \brief Reward used by Neighbors::RouteDecision to rank next hops.
+ *
+ * The Q-value of a neighbor is split in two parts, Score () which only
+ * depends on the last hello of the neighbor and Offset () which is the same
+ * for all neighbors of a node. Neighbors are ranked by score when a hello
+ * arrives and the offset is added at decision time.
+ *
+ * The staleness of a hello must therefore be linear in its age: a policy
+ * penalizing age with slope k adds k * timestamp to Score () and subtracts
+ * k * now in Offset ().
+ *
+ * A policy whose parameters can change must call NotifyChanged () when they
+ * do, so that the neighbors it ranked are ranked again.
+ */
+class RewardPolicy : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  RewardPolicy ();
+  virtual ~RewardPolicy ();
+
+  /// \return a counter incremented every time the reward changes
+  uint32_t GetVersion (void) const { return m_version; }
+
+  /**
+   * \param energy residual energy advertised by the neighbor
+   * \param meanEnergy mean energy of the neighbor's own neighbors
+   * \param value V value advertised by the neighbor
+   * \param timestamp reception time of the neighbor's last hello
+   * \return the neighbor dependent part of the Q-value
+   */
+  virtual double Score (uint32_t energy, uint32_t meanEnergy, float value, Time timestamp) const = 0;
+  /**
+   * \param energy residual energy of this node
+   * \param meanEnergy mean energy of the neighbors of this node
+   * \param value V value of this node
+   * \param now current time
+   * \return the part of the Q-value common to all neighbors
+   */
+  virtual double Offset (uint32_t energy, uint32_t meanEnergy, float value, Time now) const = 0;
+
+protected:
+  /// Record that Score () or Offset () now return other values
+  void NotifyChanged (void) { ++m_version; }
+
+private:
+  uint32_t m_version; ///< Number of changes of the reward
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Energy and staleness based reward of the Q-routing forwarder.
+ *
+ * With w = EnergyWeight, s = StalenessPenalty, d = Discount and
+ * a = NeighborValueWeight, the Q-value of neighbor i is
+ *
+ *   q = w * R (E_i, mnsE_i) - w * s / 2 * age_i + (1 - w) * (R (E, mnsE) - 0.4)
+ *     + d * (a * V_i + (1 - a) * V)
+ *
+ * where R (e, m) = -1 + e / 2e6 + atan ((e - m) / 1e6) / pi, ages are in ms
+ * and E, mnsE, V belong to this node.
+ *
+ * Neighbors calls this policy without virtual dispatch, so parameter
+ * sweeps should change its attributes rather than subclass it.
+ */
+class DefaultRewardPolicy : public RewardPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+  DefaultRewardPolicy ();
+
+  virtual double Score (uint32_t energy, uint32_t meanEnergy, float value, Time timestamp) const
+  {
+    return m_neighborEnergyWeight * EnergyReward (energy, meanEnergy)
+           + m_stalenessPerMs * timestamp.ToDouble (Time::MS)
+           + m_neighborValueWeight * value;
+  }
+  virtual double Offset (uint32_t energy, uint32_t meanEnergy, float value, Time now) const
+  {
+    return m_selfEnergyWeight * (EnergyReward (energy, meanEnergy) - 0.5 * 0.8)
+           + m_selfValueWeight * value
+           - m_stalenessPerMs * now.ToDouble (Time::MS);
+  }
+
+private:
+  /// Reward of a residual energy given the mean energy around
+  static double EnergyReward (uint32_t energy, uint32_t meanEnergy)
+  {
+    // The difference wraps around below the mean, as it always did
+    return -1.0 + 0.5 * energy / 1000000.0
+           + 0.5 * 2.0 / 3.1415927 * std::atan ((uint32_t)(energy - meanEnergy) / 1000000.0);
+  }
+  void SetEnergyWeight (double weight);
+  double GetEnergyWeight (void) const;
+  void SetStalenessPenalty (double penalty);
+  double GetStalenessPenalty (void) const;
+  void SetDiscount (double discount);
+  double GetDiscount (void) const;
+  void SetNeighborValueWeight (double weight);
+  double GetNeighborValueWeight (void) const;
+  /// Recompute the combined coefficients from the attributes
+  void Update (void);
+
+  double m_energyWeight;        ///< Weight of the neighbor reward against the reward of this node
+  double m_stalenessPenalty;    ///< Reward lost per ms of hello age
+  double m_discount;            ///< Discount of the V values
+  double m_valueWeight;         ///< Weight of the neighbor V value against the one of this node
+
+  double m_neighborEnergyWeight;
+  double m_selfEnergyWeight;
+  double m_stalenessPerMs;
+  double m_neighborValueWeight;
+  double m_selfValueWeight;
+};
+
+}
+}
+
+#endif /* AODV_REWARD_POLICY_H */
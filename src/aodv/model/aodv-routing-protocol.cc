@@ -41,6 +41,9 @@
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/energy-source-container.h"
 #include <algorithm>
 #include <limits>
 #include <sstream>
@@ -150,13 +153,21 @@ RoutingProtocol::RoutingProtocol () :
   m_seqNo (0),
   m_rreqIdCache (m_pathDiscoveryTime),
   m_dpd (m_pathDiscoveryTime),
+  m_duplicateCacheMode (IdCache::EXACT),
+  m_duplicateCacheCapacity (0),
+  m_duplicateCacheFalsePositiveRate (0.001),
   m_nb (m_helloInterval),
   m_rreqCount (0),
   m_rerrCount (0),
+  m_energyCacheTime (MilliSeconds (100)),
+  m_energyExpire (Seconds (0)),
+  m_energy (0),
+  m_energyDepleted (false),
   m_htimer (Timer::CANCEL_ON_DESTROY),
   m_rreqRateLimitTimer (Timer::CANCEL_ON_DESTROY),
   m_rerrRateLimitTimer (Timer::CANCEL_ON_DESTROY),
-  m_lastBcastTime (Seconds (0))
+  m_lastBcastTime (Seconds (0)),
+  m_helloJitter (Seconds (0))
 {
   m_nb.SetCallback (MakeCallback (&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
 }
@@ -249,6 +260,28 @@ RoutingProtocol::GetTypeId (void)
                    MakeTimeAccessor (&RoutingProtocol::SetMaxQueueTime,
                                      &RoutingProtocol::GetMaxQueueTime),
                    MakeTimeChecker ())
+    .AddAttribute ("DuplicateCacheMode",
+                   "How the RREQ ID cache and the duplicate packet detection remember IDs.",
+                   EnumValue (IdCache::EXACT),
+                   MakeEnumAccessor (&RoutingProtocol::SetDuplicateCacheMode,
+                                     &RoutingProtocol::GetDuplicateCacheMode),
+                   MakeEnumChecker (IdCache::EXACT, "Exact",
+                                    IdCache::BLOOM, "Bloom"))
+    .AddAttribute ("DuplicateCacheCapacity",
+                   "Exact mode: maximum number of IDs per cache, 0 for no limit. "
+                   "Bloom mode: IDs expected per PathDiscoveryTime, 0 for 1024.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::SetDuplicateCacheCapacity,
+                                         &RoutingProtocol::GetDuplicateCacheCapacity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DuplicateCacheFalsePositiveRate",
+                   "Bloom mode: rate of new IDs taken for duplicates when the cache holds its capacity, "
+                   "strictly between 0 and 1.",
+                   DoubleValue (0.001),
+                   MakeDoubleAccessor (&RoutingProtocol::SetDuplicateCacheFalsePositiveRate,
+                                       &RoutingProtocol::GetDuplicateCacheFalsePositiveRate),
+                   MakeDoubleChecker<double> (std::numeric_limits<double>::min (),
+                                              1.0 - std::numeric_limits<double>::epsilon ()))
     .AddAttribute ("AllowedHelloLoss", "Number of hello messages which may be loss for valid link.",
                    UintegerValue (2),
                    MakeUintegerAccessor (&RoutingProtocol::m_allowedHelloLoss),
@@ -278,6 +311,33 @@ RoutingProtocol::GetTypeId (void)
                    StringValue ("ns3::UniformRandomVariable"),
                    MakePointerAccessor (&RoutingProtocol::m_uniformRandomVariable),
                    MakePointerChecker<UniformRandomVariable> ())
+    .AddAttribute ("RewardPolicy",
+                   "Reward used to choose the next hop of forwarded data packets.",
+                   StringValue ("ns3::aodv::DefaultRewardPolicy"),
+                   MakePointerAccessor (&RoutingProtocol::SetRewardPolicy,
+                                        &RoutingProtocol::GetRewardPolicy),
+                   MakePointerChecker<RewardPolicy> ())
+    .AddAttribute ("EnergyCacheTime",
+                   "Maximum age of the residual energy read from the energy source of the node.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&RoutingProtocol::m_energyCacheTime),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Forward",
+                     "Next hop chosen for a forwarded data packet.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_forwardTrace),
+                     "ns3::aodv::RoutingProtocol::ForwardTracedCallback")
+    .AddTraceSource ("RreqIdCacheStats",
+                     "Statistics of the RREQ ID cache after each lookup.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rreqIdCacheStatsTrace),
+                     "ns3::aodv::RoutingProtocol::IdCacheStatsTracedCallback")
+    .AddTraceSource ("DuplicateCacheStats",
+                     "Statistics of the duplicate packet detection after each lookup.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_dpdStatsTrace),
+                     "ns3::aodv::RoutingProtocol::IdCacheStatsTracedCallback")
+    .AddTraceSource ("EnergyDepleted",
+                     "The node ran out of energy and left the network.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_energyDepletedTrace),
+                     "ns3::aodv::RoutingProtocol::EnergyDepletedTracedCallback")
   ;
   return tid;
 }
@@ -295,6 +355,28 @@ RoutingProtocol::SetMaxQueueTime (Time t)
   m_queue.SetQueueTimeout (t);
 }
 
+void
+RoutingProtocol::SetDuplicateCacheMode (enum IdCache::Mode mode)
+{
+  m_duplicateCacheMode = mode;
+  m_rreqIdCache.SetMode (mode, m_duplicateCacheCapacity, m_duplicateCacheFalsePositiveRate);
+  m_dpd.SetMode (mode, m_duplicateCacheCapacity, m_duplicateCacheFalsePositiveRate);
+}
+
+void
+RoutingProtocol::SetDuplicateCacheCapacity (uint32_t capacity)
+{
+  m_duplicateCacheCapacity = capacity;
+  SetDuplicateCacheMode (m_duplicateCacheMode);
+}
+
+void
+RoutingProtocol::SetDuplicateCacheFalsePositiveRate (double rate)
+{
+  m_duplicateCacheFalsePositiveRate = rate;
+  SetDuplicateCacheMode (m_duplicateCacheMode);
+}
+
 RoutingProtocol::~RoutingProtocol ()
 {
 }
@@ -315,6 +397,14 @@ RoutingProtocol::DoDispose ()
       iter->first->Close ();
     }
   m_socketSubnetBroadcastAddresses.clear ();
+  if (m_energyModel != 0)
+    {
+      // The model stays in the device energy models of the source
+      m_energyModel->SetEnergyDepletionCallback (MakeNullCallback<void> ());
+      m_energyModel->SetEnergyRechargedCallback (MakeNullCallback<void> ());
+      m_energyModel = 0;
+    }
+  m_energySource = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
 
@@ -493,7 +583,9 @@ RoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
       if (m_ipv4->GetInterfaceForAddress (iface.GetLocal ()) == iif)
         if (dst == iface.GetBroadcast () || dst.IsBroadcast ())
           {
-            if (m_dpd.IsDuplicate (p, header))
+            bool duplicate = m_dpd.IsDuplicate (p, header);
+            m_dpdStatsTrace (m_dpd.GetStats ());
+            if (duplicate)
               {
                 NS_LOG_DEBUG ("Duplicated packet " << p->GetUid () << " from " << origin << ". Drop.");
                 return true;
@@ -591,7 +683,13 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
 {
   // Time pa = Simulator::Now();
   NS_LOG_FUNCTION (this);
-  m_lo->GetNode()->SelfEnergyInDe(100,false);
+  ConsumeEnergy (100);
+  if (m_energyDepleted)
+    {
+      NS_LOG_LOGIC ("Out of energy, drop packet");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
 
   // NS_LOG_UNCOND(m_queue.GetSize());
   Ipv4Address dst = header.GetDestination ();
@@ -611,18 +709,36 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
   Ptr<Packet> packet;
   packet = p->Copy();
   addHeader ah;
-  packet->RemoveHeader(ah);
+  packet->PeekHeader(ah);
   Ipv4Address pr = ah.GetDstAddress();
-  m_route->SetGateway(m_nb.RouteDecision(nd,pr,dst)); 
+  uint32_t energy = GetResidualEnergy ();
+  Ipv4Address nextHop = m_nb.RouteDecision (nd, energy, pr, dst);
+  if (nextHop == Ipv4Address ())
+    {
+      NS_LOG_LOGIC ("No neighbor to forward to, drop packet");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+  m_route->SetGateway (nextHop);
   // NS_LOG_UNCOND("NextHop: "<<m_route->GetGateway());
   // NS_LOG_UNCOND("Previous Hop: "<<ah.GetDstAddress());
   ah.SetDstAddress(nd->GetObject<Ipv4>()->GetAddress(1,0).GetLocal());
-  NS_LOG_UNCOND("S:"<<nd->GetObject<Ipv4>()->GetAddress(1,0).GetLocal()<<"\tEnergy:"<<nd->GetSelfEnergy());
-  NS_LOG_UNCOND(m_nb.PrintOut());
+  ForwardingRecord record;
+  record.time = Simulator::Now ();
+  record.node = nd->GetId ();
+  record.address = ah.GetDstAddress ();
+  record.previousHop = pr;
+  record.nextHop = m_route->GetGateway ();
+  record.destination = dst;
+  record.energy = energy;
+  record.qValue = nd->GetSelfV_value ();
+  record.neighbors = m_nb.GetSize ();
+  m_forwardTrace (record);
+  NS_LOG_LOGIC ("S:" << record.address << "\tEnergy:" << record.energy << std::endl << m_nb.PrintOut ());
   // NS_LOG_UNCOND(m_maxQueueTime);
   // NS_LOG_UNCOND(m_maxQueueLen);
   // NS_LOG_UNCOND(m_pathDiscoveryTime);
-  packet->AddHeader(ah);
+  packet->ReplaceHeader(ah);
 
   m_nb.Update (m_route->GetGateway (), m_activeRouteTimeout);
   m_nb.Update (pr, m_activeRouteTimeout);
@@ -1026,6 +1142,7 @@ RoutingProtocol::SendRequest (Ipv4Address dst)
 
       rreqHeader.SetOrigin (iface.GetLocal ());
       m_rreqIdCache.IsDuplicate (iface.GetLocal (), m_requestId);
+      m_rreqIdCacheStatsTrace (m_rreqIdCache.GetStats ());
 
       Ptr<Packet> packet = Create<Packet> ();
       SocketIpTtlTag tag;
@@ -1228,7 +1345,9 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
    *  Node checks to determine whether it has received a RREQ with the same Originator IP Address and RREQ ID.
    *  If such a RREQ has been received, the node silently discards the newly received RREQ.
    */
-  if (m_rreqIdCache.IsDuplicate (origin, id))
+  bool duplicate = m_rreqIdCache.IsDuplicate (origin, id);
+  m_rreqIdCacheStatsTrace (m_rreqIdCache.GetStats ());
+  if (duplicate)
     {
       NS_LOG_DEBUG ("Ignoring RREQ due to duplicate");
       return;
@@ -1640,7 +1759,7 @@ void
 RoutingProtocol::ProcessHello (RrepHeader const & rrepHeader, Ipv4Address receiver )
 {
   NS_LOG_FUNCTION (this << "from " << rrepHeader.GetDst ());
-  m_lo->GetNode()->SelfEnergyInDe(50,false);
+  ConsumeEnergy (50);
   /*
    *  Whenever a node receives a Hello message from a neighbor, the node
    * SHOULD make sure that it has an active route to the neighbor, and
@@ -1788,9 +1907,14 @@ RoutingProtocol::HelloTimerExpire ()
   else
     {
       SendHello ();
+      // The next round is due one interval after the unjittered time of this one
+      offset = m_helloJitter;
     }
   m_htimer.Cancel ();
-  Time diff = m_helloInterval - offset;
+  // Hellos are jittered by delaying the timer itself rather than scheduling
+  // one more event per interface
+  m_helloJitter = Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10)));
+  Time diff = m_helloInterval - offset + m_helloJitter;
   m_htimer.Schedule (std::max (Time (Seconds (0)), diff));
   m_lastBcastTime = Time (Seconds (0));
 }
@@ -1828,20 +1952,19 @@ RoutingProtocol::SendHello ()
    *   Hop Count                      0
    *   Lifetime                       AllowedHelloLoss * HelloInterval
    */
+  // Only the addresses differ between the hellos of one round
+  RrepHeader helloHeader (/*prefix size=*/ 0, /*hops=*/ 0, /*dst=*/ Ipv4Address (), /*dst seqno=*/ m_seqNo,
+                                           /*origin=*/ Ipv4Address (),/*lifetime=*/ Time (m_allowedHelloLoss * m_helloInterval));
+  helloHeader.SetEnergy(GetResidualEnergy ());
+  helloHeader.SetValue(m_lo->GetNode()->GetSelfV_value());
+  helloHeader.SetQueueLength(0);
+  helloHeader.SetMnsEnergy(m_nb.GetMnsEnergy());
   for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
     {
       Ptr<Socket> socket = j->first;
       Ipv4InterfaceAddress iface = j->second;
-      RrepHeader helloHeader (/*prefix size=*/ 0, /*hops=*/ 0, /*dst=*/ iface.GetLocal (), /*dst seqno=*/ m_seqNo,
-                                               /*origin=*/ iface.GetLocal (),/*lifetime=*/ Time (m_allowedHelloLoss * m_helloInterval));
-      // NS_LOG_UNCOND(m_lo->GetNode()->GetSelfEnergy());
-      helloHeader.SetEnergy(m_lo->GetNode()->GetSelfEnergy());
-      helloHeader.SetValue(m_lo->GetNode()->GetSelfV_value());
-      helloHeader.SetQueueLength(0);
-      // NS_LOG_UNCOND(m_lo->GetNode()->GetSelfEnergy());
-      // NS_LOG_UNCOND(m_nb.PrintOut());
-      // NS_LOG_UNCOND(std::endl);
-      helloHeader.SetMnsEnergy(m_nb.GetMnsEnergy());
+      helloHeader.SetDst (iface.GetLocal ());
+      helloHeader.SetOrigin (iface.GetLocal ());
       Ptr<Packet> packet = Create<Packet> ();
       SocketIpTtlTag tag;
       tag.SetTtl (1);
@@ -1859,9 +1982,8 @@ RoutingProtocol::SendHello ()
         { 
           destination = iface.GetBroadcast ();
         }
-      Time jitter = Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10)));
-      m_lo->GetNode()->SelfEnergyInDe(50,false);
-      Simulator::Schedule (jitter, &RoutingProtocol::SendTo, this , socket, packet, destination);
+      ConsumeEnergy (50);
+      SendTo (socket, packet, destination);
     }
 }
 
@@ -2112,8 +2234,130 @@ RoutingProtocol::DoInitialize (void)
       NS_LOG_DEBUG ("Starting at time " << startTime << "ms");
       m_htimer.Schedule (MilliSeconds (startTime));
     }
+  ConnectEnergySource ();
   Ipv4RoutingProtocol::DoInitialize ();
 }
 
+/// Residual energy of a full battery, in the units of the Q-value
+static const uint32_t FULL_ENERGY = 1000000;
+
+void
+RoutingProtocol::ConnectEnergySource ()
+{
+  Ptr<EnergySourceContainer> sources = GetObject<EnergySourceContainer> ();
+  if (sources == 0 || sources->GetN () == 0)
+    {
+      NS_LOG_LOGIC ("No energy source, use the node energy counter");
+      return;
+    }
+  m_energySource = sources->Get (0);
+  m_energyModel = CreateObject<RoutingEnergyModel> ();
+  m_energyModel->SetEnergySource (m_energySource);
+  m_energyModel->SetEnergyDepletionCallback (MakeCallback (&RoutingProtocol::EnergyDepleted, this));
+  m_energyModel->SetEnergyRechargedCallback (MakeCallback (&RoutingProtocol::EnergyRecharged, this));
+  m_energySource->AppendDeviceEnergyModel (m_energyModel);
+}
+
+uint32_t
+RoutingProtocol::GetResidualEnergy ()
+{
+  if (m_energySource == 0)
+    {
+      return m_lo->GetNode ()->GetSelfEnergy ();
+    }
+  if (m_energyDepleted)
+    {
+      return 0;
+    }
+  if (Simulator::Now () >= m_energyExpire)
+    {
+      m_energy = static_cast<uint32_t> (m_energySource->GetEnergyFraction () * FULL_ENERGY);
+      m_energyExpire = Simulator::Now () + m_energyCacheTime;
+    }
+  return m_energy;
+}
+
+void
+RoutingProtocol::ConsumeEnergy (uint32_t e)
+{
+  if (m_energySource != 0 || m_energyDepleted)
+    {
+      // Radio consumption is accounted by the device energy models
+      return;
+    }
+  if (!m_lo->GetNode ()->SelfEnergyInDe (e, false))
+    {
+      EnergyDepleted ();
+    }
+}
+
+void
+RoutingProtocol::EnergyDepleted ()
+{
+  if (m_energyDepleted)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_energyDepleted = true;
+  m_energy = 0;
+  m_energyDepletedTrace (m_lo->GetNode ());
+  // Depletion is detected in the middle of packet processing, the
+  // interfaces can only go down once it is over
+  Simulator::ScheduleNow (&RoutingProtocol::LeaveNetwork, this);
+}
+
+void
+RoutingProtocol::EnergyRecharged ()
+{
+  if (!m_energyDepleted)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_energyDepleted = false;
+  m_energyExpire = Seconds (0);
+  Simulator::ScheduleNow (&RoutingProtocol::JoinNetwork, this);
+}
+
+void
+RoutingProtocol::LeaveNetwork ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_energyDepleted || m_ipv4 == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      if (m_ipv4->IsUp (i) && m_ipv4->GetNAddresses (i) > 0
+          && m_ipv4->GetAddress (i, 0).GetLocal () != Ipv4Address::GetLoopback ())
+        {
+          m_depletedInterfaces.push_back (i);
+          m_ipv4->SetDown (i);
+        }
+    }
+}
+
+void
+RoutingProtocol::JoinNetwork ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_energyDepleted || m_ipv4 == 0)
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = m_depletedInterfaces.begin (); i != m_depletedInterfaces.end (); ++i)
+    {
+      m_ipv4->SetUp (*i);
+    }
+  m_depletedInterfaces.clear ();
+  if (m_enableHello && !m_htimer.IsRunning ())
+    {
+      m_helloJitter = Seconds (0);
+      m_htimer.Schedule (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 100)));
+    }
+}
+
 } //namespace aodv
 } //namespace ns3
@@ -33,12 +33,15 @@
 #include "aodv-packet.h"
 #include "aodv-neighbor.h"
 #include "aodv-dpd.h"
+#include "aodv-forwarding-trace.h"
+#include "aodv-energy-model.h"
 #include "ns3/node.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/traced-callback.h"
 #include <map>
 
 namespace ns3
@@ -86,6 +89,14 @@ public:
   bool GetHelloEnable () const { return m_enableHello; }
   void SetBroadcastEnable (bool f) { m_enableBroadcast = f; }
   bool GetBroadcastEnable () const { return m_enableBroadcast; }
+  void SetDuplicateCacheMode (enum IdCache::Mode mode);
+  enum IdCache::Mode GetDuplicateCacheMode () const { return m_duplicateCacheMode; }
+  void SetDuplicateCacheCapacity (uint32_t capacity);
+  uint32_t GetDuplicateCacheCapacity () const { return m_duplicateCacheCapacity; }
+  void SetDuplicateCacheFalsePositiveRate (double rate);
+  double GetDuplicateCacheFalsePositiveRate () const { return m_duplicateCacheFalsePositiveRate; }
+  void SetRewardPolicy (Ptr<RewardPolicy> policy) { m_nb.SetRewardPolicy (policy); }
+  Ptr<RewardPolicy> GetRewardPolicy () const { return m_nb.GetRewardPolicy (); }
 
  /**
   * Assign a fixed random variable stream number to the random variables
@@ -97,6 +108,37 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Residual energy of this node in the units of the Q-value, 1000000 for
+   * a full battery. It is read from the first energy source of the node,
+   * at most once per EnergyCacheTime, or from the node energy counter if
+   * the node has no energy source.
+   *
+   * \return the residual energy
+   */
+  uint32_t GetResidualEnergy ();
+  /// Return true if the node ran out of energy and left the network
+  bool IsEnergyDepleted () const { return m_energyDepleted; }
+
+  /**
+   * TracedCallback signature for next hop decisions of forwarded data packets.
+   *
+   * \param [in] record The decision.
+   */
+  typedef void (* ForwardTracedCallback)(ForwardingRecord const & record);
+  /**
+   * TracedCallback signature for energy depletion.
+   *
+   * \param [in] node The node which left the network.
+   */
+  typedef void (* EnergyDepletedTracedCallback)(Ptr<Node> node);
+  /**
+   * TracedCallback signature for duplicate cache statistics.
+   *
+   * \param [in] stats Counters and memory use after a lookup.
+   */
+  typedef void (* IdCacheStatsTracedCallback)(IdCache::Stats const & stats);
+
 protected:
   virtual void DoInitialize (void);
 private:
@@ -161,16 +203,53 @@ private:
   IdCache m_rreqIdCache;
   /// Handle duplicated broadcast/multicast packets
   DuplicatePacketDetection m_dpd;
+  /// How m_rreqIdCache and m_dpd remember IDs
+  enum IdCache::Mode m_duplicateCacheMode;
+  uint32_t m_duplicateCacheCapacity;
+  double m_duplicateCacheFalsePositiveRate;
+  /// Statistics of m_rreqIdCache and m_dpd after each lookup
+  TracedCallback<IdCache::Stats const &> m_rreqIdCacheStatsTrace;
+  TracedCallback<IdCache::Stats const &> m_dpdStatsTrace;
   /// Handle neighbors
   Neighbors m_nb;
   /// Number of RREQs used for RREQ rate control
   uint16_t m_rreqCount;
   /// Number of RERRs used for RERR rate control
   uint16_t m_rerrCount;
+  /// Next hop decisions of forwarded data packets
+  TracedCallback<ForwardingRecord const &> m_forwardTrace;
+  /// Energy source of the node, 0 if the node energy counter is used
+  Ptr<EnergySource> m_energySource;
+  /// Model forwarding the notifications of m_energySource, 0 if none
+  Ptr<RoutingEnergyModel> m_energyModel;
+  /// Maximum age of m_energy
+  Time m_energyCacheTime;
+  /// Time m_energy has to be read again from m_energySource
+  Time m_energyExpire;
+  /// Residual energy read from m_energySource
+  uint32_t m_energy;
+  /// Indicates whether the node ran out of energy
+  bool m_energyDepleted;
+  /// Interfaces brought down when the node ran out of energy
+  std::vector<uint32_t> m_depletedInterfaces;
+  /// Energy depletion of the node
+  TracedCallback<Ptr<Node> > m_energyDepletedTrace;
 
 private:
   /// Start protocol operation
   void Start ();
+  /// Get notified by the energy source of the node, if there is one
+  void ConnectEnergySource ();
+  /// Spend e units of the node energy counter, if the node has no energy source
+  void ConsumeEnergy (uint32_t e);
+  /// Handle energy depletion of the node
+  void EnergyDepleted ();
+  /// Handle recharge of the energy source of the node
+  void EnergyRecharged ();
+  /// Bring all interfaces down
+  void LeaveNetwork ();
+  /// Bring the interfaces brought down by LeaveNetwork up again
+  void JoinNetwork ();
   /// Queue packet and send route request
   void DeferredRouteOutput (Ptr<const Packet> p, const Ipv4Header & header, UnicastForwardCallback ucb, ErrorCallback ecb);
   /// If route exists and valid, forward packet.
@@ -276,6 +355,8 @@ private:
   Ptr<UniformRandomVariable> m_uniformRandomVariable;  
   /// Keep track of the last bcast time
   Time m_lastBcastTime;
+  /// Jitter added to the current hello round by HelloTimerExpire
+  Time m_helloJitter;
 };
 
 }
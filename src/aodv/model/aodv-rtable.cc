@@ -29,6 +29,7 @@
 #include "aodv-rtable.h"
 #include <algorithm>
 #include <iomanip>
+#include <vector>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -238,6 +239,7 @@ RoutingTable::DeleteRoute (Ipv4Address dst)
   Purge ();
   if (m_ipv4AddressEntry.erase (dst) != 0)
     {
+      Unindex (dst);
       NS_LOG_LOGIC ("Route deletion to " << dst << " successful");
       return true;
     }
@@ -254,6 +256,10 @@ RoutingTable::AddRoute (RoutingTableEntry & rt)
     rt.SetRreqCnt (0);
   std::pair<std::map<Ipv4Address, RoutingTableEntry>::iterator, bool> result =
     m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt));
+  if (result.second)
+    {
+      Index (result.first->second);
+    }
   return result.second;
 }
 
@@ -274,6 +280,7 @@ RoutingTable::Update (RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " set RreqCnt to 0");
       i->second.SetRreqCnt (0);
     }
+  Index (i->second);
   return true;
 }
 
@@ -300,14 +307,14 @@ RoutingTable::GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv
   NS_LOG_FUNCTION (this);
   Purge ();
   unreachable.clear ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (std::set<std::pair<Ipv4Address, Ipv4Address> >::const_iterator i =
+         m_nextHopIndex.lower_bound (std::make_pair (nextHop, Ipv4Address::GetAny ()));
+       i != m_nextHopIndex.end () && i->first == nextHop; ++i)
     {
-      if (i->second.GetNextHop () == nextHop)
-        {
-          NS_LOG_LOGIC ("Unreachable insert " << i->first << " " << i->second.GetSeqNo ());
-          unreachable.insert (std::make_pair (i->first, i->second.GetSeqNo ()));
-        }
+      RoutingTableEntry const & rt = m_ipv4AddressEntry.find (i->second)->second;
+      NS_ASSERT_MSG (rt.GetNextHop () == nextHop, "Next hop of " << i->second << " changed without Update");
+      NS_LOG_LOGIC ("Unreachable insert " << i->second << " " << rt.GetSeqNo ());
+      unreachable.insert (std::make_pair (i->second, rt.GetSeqNo ()));
     }
 }
 
@@ -316,17 +323,16 @@ RoutingTable::InvalidateRoutesWithDst (const std::map<Ipv4Address, uint32_t> & u
 {
   NS_LOG_FUNCTION (this);
   Purge ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (std::map<Ipv4Address, uint32_t>::const_iterator j =
+         unreachable.begin (); j != unreachable.end (); ++j)
     {
-      for (std::map<Ipv4Address, uint32_t>::const_iterator j =
-             unreachable.begin (); j != unreachable.end (); ++j)
+      std::map<Ipv4Address, RoutingTableEntry>::iterator i =
+        m_ipv4AddressEntry.find (j->first);
+      if ((i != m_ipv4AddressEntry.end ()) && (i->second.GetFlag () == VALID))
         {
-          if ((i->first == j->first) && (i->second.GetFlag () == VALID))
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-            }
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.Invalidate (m_badLinkLifetime);
+          Index (i->second);
         }
     }
 }
@@ -344,6 +350,7 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
         {
           std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
           ++i;
+          Unindex (tmp->first);
           m_ipv4AddressEntry.erase (tmp);
         }
       else
@@ -351,39 +358,79 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
     }
 }
 
+void
+RoutingTable::Clear ()
+{
+  m_ipv4AddressEntry.clear ();
+  m_indexed.clear ();
+  m_nextHopIndex.clear ();
+  m_expiry.clear ();
+}
+
 void
 RoutingTable::Purge ()
 {
   NS_LOG_FUNCTION (this);
   if (m_ipv4AddressEntry.empty ())
     return;
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end ();)
+  // m_expiry is ordered by lifetime, so only expired entries are visited
+  std::vector<Ipv4Address> expired;
+  Time now = Simulator::Now ();
+  for (std::set<std::pair<Time, Ipv4Address> >::const_iterator i = m_expiry.begin ();
+       i != m_expiry.end () && i->first < now; ++i)
     {
-      if (i->second.GetLifeTime () < Seconds (0))
+      expired.push_back (i->second);
+    }
+  for (std::vector<Ipv4Address>::const_iterator dst = expired.begin (); dst != expired.end (); ++dst)
+    {
+      std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.find (*dst);
+      if (i->second.GetFlag () == INVALID)
         {
-          if (i->second.GetFlag () == INVALID)
-            {
-              std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
-              ++i;
-              m_ipv4AddressEntry.erase (tmp);
-            }
-          else if (i->second.GetFlag () == VALID)
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-              ++i;
-            }
-          else
-            ++i;
+          Unindex (i->first);
+          m_ipv4AddressEntry.erase (i);
         }
-      else 
+      else if (i->second.GetFlag () == VALID)
         {
-          ++i;
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.Invalidate (m_badLinkLifetime);
+          Index (i->second);
         }
     }
 }
 
+void
+RoutingTable::Index (RoutingTableEntry const & rt)
+{
+  Ipv4Address dst = rt.GetDestination ();
+  std::pair<Ipv4Address, Time> key (rt.GetNextHop (), rt.GetLifeTime () + Simulator::Now ());
+  std::map<Ipv4Address, std::pair<Ipv4Address, Time> >::iterator i = m_indexed.find (dst);
+  if (i != m_indexed.end ())
+    {
+      if (i->second == key)
+        return;
+      m_nextHopIndex.erase (std::make_pair (i->second.first, dst));
+      m_expiry.erase (std::make_pair (i->second.second, dst));
+      i->second = key;
+    }
+  else
+    {
+      m_indexed.insert (std::make_pair (dst, key));
+    }
+  m_nextHopIndex.insert (std::make_pair (key.first, dst));
+  m_expiry.insert (std::make_pair (key.second, dst));
+}
+
+void
+RoutingTable::Unindex (Ipv4Address dst)
+{
+  std::map<Ipv4Address, std::pair<Ipv4Address, Time> >::iterator i = m_indexed.find (dst);
+  if (i == m_indexed.end ())
+    return;
+  m_nextHopIndex.erase (std::make_pair (i->second.first, dst));
+  m_expiry.erase (std::make_pair (i->second.second, dst));
+  m_indexed.erase (i);
+}
+
 void
 RoutingTable::Purge (std::map<Ipv4Address, RoutingTableEntry> &table) const
 {
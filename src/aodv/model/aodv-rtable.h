@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <cassert>
 #include <map>
+#include <set>
 #include <sys/types.h>
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-route.h"
@@ -232,7 +233,7 @@ public:
   /// Delete all route from interface with address iface
   void DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface);
   /// Delete all entries from routing table
-  void Clear () { m_ipv4AddressEntry.clear (); }
+  void Clear ();
   /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
   void Purge ();
   /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout period)
@@ -246,10 +247,23 @@ public:
 
 private:
   std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  /// Next hop and absolute lifetime each destination is indexed with
+  std::map<Ipv4Address, std::pair<Ipv4Address, Time> > m_indexed;
+  /// Destinations by next hop, so that a broken link does not scan all routes
+  std::set<std::pair<Ipv4Address, Ipv4Address> > m_nextHopIndex;
+  /// Destinations by absolute lifetime, so that Purge only visits expired routes
+  std::set<std::pair<Time, Ipv4Address> > m_expiry;
   /// Deletion time for invalid routes
   Time m_badLinkLifetime;
   /// const version of Purge, for use by Print() method
   void Purge (std::map<Ipv4Address, RoutingTableEntry> &table) const;
+  /**
+   * Index rt under its current next hop and lifetime. Must follow every
+   * change of the next hop or lifetime of an entry of the table.
+   */
+  void Index (RoutingTableEntry const & rt);
+  /// Remove destination dst from the indexes
+  void Unindex (Ipv4Address dst);
 };
 
 }
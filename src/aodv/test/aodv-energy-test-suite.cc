@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/aodv-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/basic-energy-source.h"
+#include "ns3/simple-device-energy-model.h"
+#include "ns3/energy-source-container.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+namespace ns3
+{
+namespace aodv
+{
+
+/// Unit test for the energy counter of the node
+class NodeEnergyCounterTest : public TestCase
+{
+public:
+  NodeEnergyCounterTest () : TestCase ("Node energy counter") {}
+  virtual void DoRun ();
+};
+
+void
+NodeEnergyCounterTest::DoRun ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  node->SetSelfEnergy (120);
+  NS_TEST_EXPECT_MSG_EQ (node->SelfEnergyInDe (100, false), true, "Enough energy");
+  NS_TEST_EXPECT_MSG_EQ (node->GetSelfEnergy (), 20, "Energy removed");
+  NS_TEST_EXPECT_MSG_EQ (node->SelfEnergyInDe (50, false), false, "Not enough energy");
+  NS_TEST_EXPECT_MSG_EQ (node->GetSelfEnergy (), 0, "Energy exhausted");
+  NS_TEST_EXPECT_MSG_EQ (node->SelfEnergyInDe (30, true), true, "Energy added");
+  NS_TEST_EXPECT_MSG_EQ (node->GetSelfEnergy (), 30, "Energy added");
+}
+
+/// Unit test for a routing protocol backed by an energy source
+class EnergySourceTest : public TestCase
+{
+public:
+  EnergySourceTest () : TestCase ("Energy source depletion"), m_depleted (0) {}
+  virtual void DoRun ();
+  /// EnergyDepleted trace sink
+  void Depleted (Ptr<Node> node) { ++m_depleted; m_depletionTime = Simulator::Now (); }
+  /// Check residual energy and interface state of the protocol
+  void Check (Ptr<RoutingProtocol> aodv, Ptr<Ipv4> ipv4, double energy, bool up);
+
+private:
+  /// Number of depletion notifications
+  uint32_t m_depleted;
+  /// Time of the last notification
+  Time m_depletionTime;
+};
+
+void
+EnergySourceTest::Check (Ptr<RoutingProtocol> aodv, Ptr<Ipv4> ipv4, double energy, bool up)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL ((double) aodv->GetResidualEnergy (), energy, 1.0, "Residual energy at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (aodv->IsEnergyDepleted (), !up, "Depletion state at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (ipv4->IsUp (1), up, "Interface state at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+EnergySourceTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  AodvHelper aodv;
+  // Only the checks below read the energy source
+  aodv.Set ("EnableHello", BooleanValue (false));
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (aodv);
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+
+  // 10 J drained at 1 W, the source reports depletion at 10% of its energy
+  Ptr<BasicEnergySource> source = CreateObject<BasicEnergySource> ();
+  source->SetInitialEnergy (10);
+  source->SetSupplyVoltage (1);
+  source->SetAttribute ("PeriodicEnergyUpdateInterval", TimeValue (MilliSeconds (500)));
+  source->SetNode (nodes.Get (0));
+  Ptr<EnergySourceContainer> sources = CreateObject<EnergySourceContainer> ();
+  sources->Add (source);
+  nodes.Get (0)->AggregateObject (sources);
+  Ptr<SimpleDeviceEnergyModel> load = CreateObject<SimpleDeviceEnergyModel> ();
+  load->SetEnergySource (source);
+  load->SetNode (nodes.Get (0));
+  source->AppendDeviceEnergyModel (load);
+  load->SetCurrentA (1);
+
+  Ptr<RoutingProtocol> routing = nodes.Get (0)->GetObject<RoutingProtocol> ();
+  Ptr<Ipv4> ipv4 = nodes.Get (0)->GetObject<Ipv4> ();
+  // An interface left without address is skipped when the node leaves
+  Ptr<SimpleNetDevice> bare = CreateObject<SimpleNetDevice> ();
+  bare->SetAddress (Mac48Address::Allocate ());
+  nodes.Get (0)->AddDevice (bare);
+  uint32_t bareInterface = ipv4->AddInterface (bare);
+  ipv4->AddAddress (bareInterface, Ipv4InterfaceAddress ("10.2.2.1", "255.255.255.0"));
+  ipv4->SetUp (bareInterface);
+  ipv4->RemoveAddress (bareInterface, 0);
+  routing->SetAttribute ("EnergyCacheTime", TimeValue (Seconds (1)));
+  routing->TraceConnectWithoutContext ("EnergyDepleted", MakeCallback (&EnergySourceTest::Depleted, this));
+
+  Simulator::Schedule (Seconds (0.1), &EnergySourceTest::Check, this, routing, ipv4, 990000.0, true);
+  // Cached for EnergyCacheTime
+  Simulator::Schedule (Seconds (0.6), &EnergySourceTest::Check, this, routing, ipv4, 990000.0, true);
+  Simulator::Schedule (Seconds (1.6), &EnergySourceTest::Check, this, routing, ipv4, 840000.0, true);
+  Simulator::Schedule (Seconds (9.6), &EnergySourceTest::Check, this, routing, ipv4, 0.0, false);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_depleted, 1, "Depletion notified once");
+  // The source is updated at least every PeriodicEnergyUpdateInterval
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_depletionTime, Seconds (9), MilliSeconds (500), "Depletion below 10% of the initial energy");
+
+  // Notifications of the source no longer reach a disposed protocol
+  DeviceEnergyModelContainer models = source->FindDeviceEnergyModels (RoutingEnergyModel::GetTypeId ());
+  NS_TEST_ASSERT_MSG_EQ (models.GetN (), 1, "Routing energy model installed");
+  routing->Dispose ();
+  models.Get (0)->HandleEnergyRecharged ();
+  NS_TEST_EXPECT_MSG_EQ (routing->IsEnergyDepleted (), true, "Recharge ignored after dispose");
+  Simulator::Destroy ();
+}
+
+class EnergyTestSuite : public TestSuite
+{
+public:
+  EnergyTestSuite () : TestSuite ("aodv-routing-energy", UNIT)
+  {
+    AddTestCase (new NodeEnergyCounterTest, TestCase::QUICK);
+    AddTestCase (new EnergySourceTest, TestCase::QUICK);
+  }
+} g_energyTestSuite;
+
+}
+}
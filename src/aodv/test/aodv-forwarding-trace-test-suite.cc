@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-forwarding-trace.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+namespace aodv
+{
+
+/// Unit test for the forwarding trace sink
+class ForwardingTraceSinkTest : public TestCase
+{
+public:
+  ForwardingTraceSinkTest () : TestCase ("Forwarding trace sink") {}
+  virtual void DoRun ();
+  /// Record number i
+  ForwardingRecord MakeRecord (uint32_t i);
+};
+
+ForwardingRecord
+ForwardingTraceSinkTest::MakeRecord (uint32_t i)
+{
+  ForwardingRecord r;
+  r.time = MilliSeconds (1000 + i);
+  r.node = i;
+  r.address = Ipv4Address ("10.1.1.2");
+  r.previousHop = Ipv4Address ("10.1.1.1");
+  r.nextHop = Ipv4Address ("10.1.1.3");
+  r.destination = Ipv4Address ("10.1.1.25");
+  r.energy = 999900 - i;
+  r.qValue = -0.5;
+  r.neighbors = 4;
+  return r;
+}
+
+void
+ForwardingTraceSinkTest::DoRun ()
+{
+  std::string csv = CreateTempDirFilename ("forwarding.csv");
+  std::string bin = CreateTempDirFilename ("forwarding.bin");
+  {
+    Ptr<ForwardingTraceSink> sink = Create<ForwardingTraceSink> (csv, ForwardingTraceSink::CSV, 2);
+    Ptr<ForwardingTraceSink> binary = Create<ForwardingTraceSink> (bin, ForwardingTraceSink::BINARY, 2);
+    for (uint32_t i = 0; i < 5; ++i)
+      {
+        sink->Record (MakeRecord (i));
+        binary->Record (MakeRecord (i));
+      }
+    std::ifstream partial (csv.c_str ());
+    std::stringstream written;
+    written << partial.rdbuf ();
+    NS_TEST_EXPECT_MSG_EQ ((written.str ().size () > 0), true, "Full buffers are written");
+    NS_TEST_EXPECT_MSG_EQ (sink->GetRecords (), 5, "All records counted");
+  }
+
+  std::ifstream in (csv.c_str ());
+  std::string line;
+  uint32_t lines = 0;
+  while (std::getline (in, line))
+    {
+      if (lines == 4)
+        {
+          NS_TEST_EXPECT_MSG_EQ (line, "1004000000,4,10.1.1.2,10.1.1.1,10.1.1.3,10.1.1.25,999896,-0.5,4", "CSV record");
+        }
+      ++lines;
+    }
+  NS_TEST_EXPECT_MSG_EQ (lines, 5, "Remaining records written on destruction");
+
+  std::ifstream raw (bin.c_str (), std::ios_base::binary);
+  std::stringstream bytes;
+  bytes << raw.rdbuf ();
+  std::string data = bytes.str ();
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 5 * 40, "40 bytes per binary record");
+  uint64_t time = 0;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      time |= (uint64_t)(uint8_t) data[40 + i] << (8 * i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (time, 1001000000, "Little-endian time in ns");
+  uint32_t node = (uint8_t) data[48] | ((uint8_t) data[49] << 8);
+  NS_TEST_EXPECT_MSG_EQ (node, 1, "Node id follows the time");
+}
+
+class ForwardingTraceTestSuite : public TestSuite
+{
+public:
+  ForwardingTraceTestSuite () : TestSuite ("aodv-routing-forwarding-trace", UNIT)
+  {
+    AddTestCase (new ForwardingTraceSinkTest, TestCase::QUICK);
+  }
+} g_forwardingTraceTestSuite;
+
+}
+}
@@ -26,6 +26,8 @@
  *          Pavel Boyko <boyko@iitp.ru>
  */
 #include "ns3/aodv-id-cache.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/double.h"
 #include "ns3/test.h"
 
 namespace ns3
@@ -93,12 +95,158 @@ IdCacheTest::CheckTimeout3 ()
   NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 0, "All records expire");
 }
 //-----------------------------------------------------------------------------
+/// Unit test for id cache size limit and statistics
+class IdCacheCapacityTest : public TestCase
+{
+public:
+  IdCacheCapacityTest () : TestCase ("Id Cache capacity") {}
+  virtual void DoRun ();
+};
+
+void
+IdCacheCapacityTest::DoRun ()
+{
+  IdCache cache (Seconds (10));
+  cache.SetMode (IdCache::EXACT, 2, 0.01);
+  cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 1);
+  cache.SetLifetime (Seconds (20));
+  cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 2);
+  cache.SetLifetime (Seconds (5));
+  cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 3);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 2, "Capacity");
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 2), true, "Latest expiry kept");
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 3), true, "New entry kept");
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.1.1.1"), 1), false, "Earliest expiry dropped");
+  IdCache::Stats stats = cache.GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.lookups, 6, "Lookups");
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, 2, "Hits");
+  NS_TEST_EXPECT_MSG_EQ (stats.entries, 2, "Entries");
+  NS_TEST_EXPECT_MSG_EQ ((stats.bytes > 0), true, "Memory");
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
+/// Unit test for the Bloom filter id cache
+class IdCacheBloomTest : public TestCase
+{
+public:
+  IdCacheBloomTest () : TestCase ("Id Cache Bloom filters"), cache (Seconds (10))
+  {}
+  virtual void DoRun ();
+
+private:
+  /// Count the known IDs among count IDs of addr starting at first
+  uint32_t Known (Ipv4Address addr, uint32_t first, uint32_t count);
+  void CheckRemembered ();
+  void CheckForgotten ();
+
+  IdCache cache;
+};
+
+uint32_t
+IdCacheBloomTest::Known (Ipv4Address addr, uint32_t first, uint32_t count)
+{
+  uint32_t known = 0;
+  for (uint32_t id = first; id < first + count; ++id)
+    {
+      known += cache.IsDuplicate (addr, id);
+    }
+  return known;
+}
+
+void
+IdCacheBloomTest::DoRun ()
+{
+  cache.SetMode (IdCache::BLOOM, 1000, 0.01);
+  NS_TEST_EXPECT_MSG_EQ (cache.GetMode (), IdCache::BLOOM, "Mode");
+  // 9.585 bits per ID for 1% false positives, rounded up to 64 bit words, two filters
+  NS_TEST_EXPECT_MSG_EQ (cache.GetStats ().bytes, 2 * 150 * 8, "Fixed memory");
+  uint32_t falsePositives = Known (Ipv4Address ("10.0.0.1"), 0, 1000);
+  NS_TEST_EXPECT_MSG_LT (falsePositives, 30, "Few unknown IDs taken for duplicates");
+  NS_TEST_EXPECT_MSG_EQ (Known (Ipv4Address ("10.0.0.1"), 0, 1000), 1000, "No false negatives");
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 1000 - falsePositives, "IDs inserted");
+
+  Simulator::Schedule (Seconds (15), &IdCacheBloomTest::CheckRemembered, this);
+  Simulator::Schedule (Seconds (25), &IdCacheBloomTest::CheckForgotten, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+IdCacheBloomTest::CheckRemembered ()
+{
+  NS_TEST_EXPECT_MSG_EQ (Known (Ipv4Address ("10.0.0.1"), 0, 1000), 1000, "IDs remembered in the previous filter");
+}
+
+void
+IdCacheBloomTest::CheckForgotten ()
+{
+  NS_TEST_EXPECT_MSG_LT (Known (Ipv4Address ("10.0.0.1"), 0, 1000), 30, "IDs forgotten after two lifetimes");
+}
+//-----------------------------------------------------------------------------
+/// Unit test for a change of lifetime of the Bloom filter id cache
+class IdCacheBloomLifetimeTest : public TestCase
+{
+public:
+  IdCacheBloomLifetimeTest () : TestCase ("Id Cache Bloom filters lifetime"), cache (Seconds (10))
+  {}
+  virtual void DoRun ();
+
+private:
+  void Shorten ();
+  void CheckForgotten ();
+
+  IdCache cache;
+};
+
+void
+IdCacheBloomLifetimeTest::DoRun ()
+{
+  Ptr<RoutingProtocol> aodv = CreateObject<RoutingProtocol> ();
+  NS_TEST_EXPECT_MSG_EQ (aodv->SetAttributeFailSafe ("DuplicateCacheFalsePositiveRate", DoubleValue (0)), false,
+                         "False positive rate of 0 rejected");
+  NS_TEST_EXPECT_MSG_EQ (aodv->SetAttributeFailSafe ("DuplicateCacheFalsePositiveRate", DoubleValue (1)), false,
+                         "False positive rate of 1 rejected");
+  NS_TEST_EXPECT_MSG_EQ (aodv->SetAttributeFailSafe ("DuplicateCacheFalsePositiveRate", DoubleValue (0.5)), true,
+                         "False positive rate of 0.5 accepted");
+  aodv->Dispose ();
+
+  cache.SetMode (IdCache::BLOOM, 1000, 0.01);
+  for (uint32_t id = 0; id < 1000; ++id)
+    {
+      cache.IsDuplicate (Ipv4Address ("10.0.0.1"), id);
+    }
+  Simulator::Schedule (Seconds (1), &IdCacheBloomLifetimeTest::Shorten, this);
+  Simulator::Schedule (Seconds (5), &IdCacheBloomLifetimeTest::CheckForgotten, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+IdCacheBloomLifetimeTest::Shorten ()
+{
+  cache.SetLifetime (Seconds (2));
+}
+
+void
+IdCacheBloomLifetimeTest::CheckForgotten ()
+{
+  uint32_t known = 0;
+  for (uint32_t id = 0; id < 1000; ++id)
+    {
+      known += cache.IsDuplicate (Ipv4Address ("10.0.0.1"), id);
+    }
+  NS_TEST_EXPECT_MSG_LT (known, 30, "IDs forgotten after two of the new lifetimes");
+}
+//-----------------------------------------------------------------------------
 class IdCacheTestSuite : public TestSuite
 {
 public:
   IdCacheTestSuite () : TestSuite ("aodv-routing-id-cache", UNIT)
   {
     AddTestCase (new IdCacheTest, TestCase::QUICK);
+    AddTestCase (new IdCacheCapacityTest, TestCase::QUICK);
+    AddTestCase (new IdCacheBloomTest, TestCase::QUICK);
+    AddTestCase (new IdCacheBloomLifetimeTest, TestCase::QUICK);
   }
 } g_idCacheTestSuite;
 
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-reward-policy.h"
+#include "ns3/aodv-neighbor.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/aodv-helper.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/test.h"
+#include <cmath>
+
+namespace ns3
+{
+namespace aodv
+{
+
+//-----------------------------------------------------------------------------
+/// Default policy reproduces the formula it replaced
+class DefaultRewardPolicyTest : public TestCase
+{
+public:
+  DefaultRewardPolicyTest () : TestCase ("Default reward policy") {}
+  virtual void DoRun ();
+};
+
+void
+DefaultRewardPolicyTest::DoRun ()
+{
+  Ptr<DefaultRewardPolicy> policy = CreateObject<DefaultRewardPolicy> ();
+  uint32_t e = 950000, mnsE = 900000, se = 800000, mns = 850000;
+  float v = 0.2, sv = 0.5;
+  Time timestamp = MilliSeconds (1200), now = MilliSeconds (1700);
+  double age = (now - timestamp).GetMilliSeconds ();
+  double q = 0.9 * (-1.0 + 0.5 * e / 1000000.0 + 0.5 * 2.0 / 3.1415927 * std::atan ((e - mnsE) / 1000000.0) - 0.5 / 50.0 * age)
+    + 0.1 * (-1.0 + 0.5 * se / 1000000.0 + 0.5 * 2.0 / 3.1415927 * std::atan ((se - mns) / 1000000.0) - 0.5 * 0.8)
+    + 0.9 * (0.7 * v + 0.3 * sv);
+  NS_TEST_EXPECT_MSG_EQ_TOL (policy->Score (e, mnsE, v, timestamp) + policy->Offset (se, mns, sv, now), q, 1e-9, "Same Q-value");
+
+  policy->SetAttribute ("EnergyWeight", DoubleValue (1.0));
+  policy->SetAttribute ("Discount", DoubleValue (0.0));
+  NS_TEST_EXPECT_MSG_EQ_TOL (policy->Offset (se, mns, sv, now), -0.5 / 50.0 * now.GetMilliSeconds (), 1e-9,
+                             "Only staleness is left in the offset");
+  NS_TEST_EXPECT_MSG_EQ_TOL (policy->Score (e, mnsE, 0.9, timestamp), policy->Score (e, mnsE, 0.1, timestamp), 1e-9,
+                             "V values are ignored without discount");
+}
+
+//-----------------------------------------------------------------------------
+/// Prefers the neighbor with the least energy left
+class LeastEnergyRewardPolicy : public RewardPolicy
+{
+public:
+  virtual double Score (uint32_t energy, uint32_t meanEnergy, float value, Time timestamp) const
+  {
+    return -(double) energy;
+  }
+  virtual double Offset (uint32_t energy, uint32_t meanEnergy, float value, Time now) const
+  {
+    return 0;
+  }
+};
+
+/// Neighbors and the AODV helper use the configured policy
+class RewardPolicySelectionTest : public TestCase
+{
+public:
+  RewardPolicySelectionTest () : TestCase ("Reward policy selection") {}
+  virtual void DoRun ();
+};
+
+void
+RewardPolicySelectionTest::DoRun ()
+{
+  Ptr<Node> nd = CreateObject<Node> ();
+  nd->SetSelfEnergy (800000);
+  Neighbors nb (Seconds (10));
+  NS_TEST_EXPECT_MSG_EQ (nb.GetRewardPolicy (), 0, "No policy before the first entry");
+  nb.Update (Ipv4Address ("1.1.1.1"), Seconds (5), 900000, 0.1, 0, 800000);
+  nb.Update (Ipv4Address ("2.2.2.2"), Seconds (5), 700000, 0.2, 0, 900000);
+  nb.Update (Ipv4Address ("3.3.3.3"), Seconds (5), 990000, 0.0, 0, 1000000);
+  NS_TEST_EXPECT_MSG_EQ (nb.GetRewardPolicy ()->GetInstanceTypeId (), DefaultRewardPolicy::GetTypeId (),
+                         "Default policy created with the first entry");
+  NS_TEST_EXPECT_MSG_EQ (nb.RouteDecision (nd, Ipv4Address ("9.9.9.9"), Ipv4Address ("8.8.8.8")), Ipv4Address ("3.3.3.3"),
+                         "Default policy prefers energy");
+  // Ranked entries follow a change of the policy attributes
+  nb.GetRewardPolicy ()->SetAttribute ("EnergyWeight", DoubleValue (0.1));
+  NS_TEST_EXPECT_MSG_EQ (nb.RouteDecision (nd, Ipv4Address ("9.9.9.9"), Ipv4Address ("8.8.8.8")), Ipv4Address ("2.2.2.2"),
+                         "Entries are ranked again when the policy changes");
+  Neighbors fresh (Seconds (10));
+  Ptr<DefaultRewardPolicy> reference = CreateObject<DefaultRewardPolicy> ();
+  reference->SetAttribute ("EnergyWeight", DoubleValue (0.1));
+  fresh.SetRewardPolicy (reference);
+  fresh.Update (Ipv4Address ("1.1.1.1"), Seconds (5), 900000, 0.1, 0, 800000);
+  fresh.Update (Ipv4Address ("2.2.2.2"), Seconds (5), 700000, 0.2, 0, 900000);
+  fresh.Update (Ipv4Address ("3.3.3.3"), Seconds (5), 990000, 0.0, 0, 1000000);
+  Ptr<Node> other = CreateObject<Node> ();
+  other->SetSelfEnergy (800000);
+  nd->SetSelfV_value (0);
+  other->SetSelfV_value (0);
+  NS_TEST_EXPECT_MSG_EQ (nb.RouteDecision (nd, Ipv4Address ("9.9.9.9"), Ipv4Address ("8.8.8.8")),
+                         fresh.RouteDecision (other, Ipv4Address ("9.9.9.9"), Ipv4Address ("8.8.8.8")),
+                         "Same decision as a table ranked with the new policy only");
+  NS_TEST_EXPECT_MSG_EQ_TOL (nd->GetSelfV_value (), other->GetSelfV_value (), 1e-6, "Same Q-value");
+  nb.SetRewardPolicy (CreateObject<LeastEnergyRewardPolicy> ());
+  NS_TEST_EXPECT_MSG_EQ (nb.RouteDecision (nd, Ipv4Address ("9.9.9.9"), Ipv4Address ("8.8.8.8")), Ipv4Address ("2.2.2.2"),
+                         "Entries are ranked again with the new policy");
+  NS_TEST_EXPECT_MSG_EQ (nd->GetSelfV_value (), -700000, "V value comes from the new policy");
+  nb.Clear ();
+
+  AodvHelper aodv;
+  aodv.SetRewardPolicy ("ns3::aodv::DefaultRewardPolicy", "Discount", DoubleValue (0.5));
+  Ptr<RoutingProtocol> a = DynamicCast<RoutingProtocol> (aodv.Create (CreateObject<Node> ()));
+  Ptr<RoutingProtocol> b = DynamicCast<RoutingProtocol> (aodv.Create (CreateObject<Node> ()));
+  NS_TEST_ASSERT_MSG_NE (a->GetRewardPolicy (), b->GetRewardPolicy (), "One policy per routing protocol");
+  DoubleValue discount;
+  a->GetRewardPolicy ()->GetAttribute ("Discount", discount);
+  NS_TEST_EXPECT_MSG_EQ_TOL (discount.Get (), 0.5, 1e-9, "Policy attributes are applied");
+  PointerValue policy;
+  b->GetAttribute ("RewardPolicy", policy);
+  NS_TEST_EXPECT_MSG_EQ (policy.Get<RewardPolicy> (), b->GetRewardPolicy (), "RewardPolicy attribute");
+}
+
+//-----------------------------------------------------------------------------
+class RewardPolicyTestSuite : public TestSuite
+{
+public:
+  RewardPolicyTestSuite () : TestSuite ("aodv-routing-reward-policy", UNIT)
+  {
+    AddTestCase (new DefaultRewardPolicyTest, TestCase::QUICK);
+    AddTestCase (new RewardPolicySelectionTest, TestCase::QUICK);
+  }
+} g_rewardPolicyTestSuite;
+
+}
+}
@@ -23,6 +23,7 @@
 #include "ns3/aodv-rqueue.h"
 #include "ns3/aodv-rtable.h"
 #include "ns3/ipv4-route.h"
+#include <cmath>
 
 namespace ns3
 {
@@ -95,6 +96,188 @@ NeighborTest::DoRun ()
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+/// Unit test for neighbor expiry and ordering
+struct NeighborPurgeTest : public TestCase
+{
+  NeighborPurgeTest () : TestCase ("Neighbor purge"), neighbor (0) { }
+  virtual void DoRun ();
+  void Handler (Ipv4Address addr);
+  void CheckPurge ();
+  Neighbors * neighbor;
+  std::vector<Ipv4Address> closed;
+};
+
+void
+NeighborPurgeTest::Handler (Ipv4Address addr)
+{
+  closed.push_back (addr);
+}
+
+void
+NeighborPurgeTest::CheckPurge ()
+{
+  neighbor->Purge ();
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetSize (), 2, "Two neighbors left");
+  NS_TEST_EXPECT_MSG_EQ (closed.size (), 3, "Three links closed");
+  NS_TEST_EXPECT_MSG_EQ (closed[0], Ipv4Address ("1.1.1.1"), "Links closed in list order");
+  NS_TEST_EXPECT_MSG_EQ (closed[1], Ipv4Address ("3.3.3.3"), "Links closed in list order");
+  NS_TEST_EXPECT_MSG_EQ (closed[2], Ipv4Address ("4.4.4.4"), "Links closed in list order");
+  std::vector<Neighbors::Neighbor> list = neighbor->GetNeighborsList ();
+  NS_TEST_EXPECT_MSG_EQ (list[0].m_neighborAddress, Ipv4Address ("2.2.2.2"), "Insertion order kept");
+  NS_TEST_EXPECT_MSG_EQ (list[1].m_neighborAddress, Ipv4Address ("5.5.5.5"), "Insertion order kept");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetExpireTime (Ipv4Address ("5.5.5.5")), Seconds (2), "Known expire time");
+  NS_TEST_EXPECT_MSG_EQ (list[1].m_energy, 7, "Energy updated in place");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetMnsEnergy (), 3, "Mean energy of the survivors");
+  neighbor->Clear ();
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetMnsEnergy (), 0, "No neighbors");
+}
+
+void
+NeighborPurgeTest::DoRun ()
+{
+  // Long purge interval, so that all expired entries go in one Purge ()
+  Neighbors nb (Seconds (10));
+  neighbor = &nb;
+  neighbor->SetCallback (MakeCallback (&NeighborPurgeTest::Handler, this));
+  neighbor->Update (Ipv4Address ("1.1.1.1"), Seconds (3));
+  neighbor->Update (Ipv4Address ("2.2.2.2"), Seconds (10));
+  neighbor->Update (Ipv4Address ("3.3.3.3"), Seconds (2));
+  neighbor->Update (Ipv4Address ("4.4.4.4"), Seconds (1));
+  neighbor->Update (Ipv4Address ("5.5.5.5"), Seconds (1), 5, 0, 0, 0);
+  // Shorter lifetime does not shrink the expire time, longer one extends it
+  neighbor->Update (Ipv4Address ("2.2.2.2"), Seconds (1));
+  neighbor->Update (Ipv4Address ("5.5.5.5"), Seconds (6), 7, 0, 0, 0);
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetSize (), 5, "Five neighbors");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetExpireTime (Ipv4Address ("2.2.2.2")), Seconds (10), "Known expire time");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetMnsEnergy (), 1, "Mean energy follows updates");
+
+  Simulator::Schedule (Seconds (4), &NeighborPurgeTest::CheckPurge, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
+/// Unit test for next hop selection by Q-value
+struct NeighborDecisionTest : public TestCase
+{
+  NeighborDecisionTest () : TestCase ("Neighbor route decision"), neighbor (0) { }
+  virtual void DoRun ();
+  /// Q-value of nb in the original scan over the neighbor list
+  float ReferenceQ (Neighbors::Neighbor const & nb, uint32_t se, float sv, uint32_t mns_energy, Ipv4Address preHop, Ipv4Address dst);
+  /// Next hop chosen by the original two-pass scan over the neighbor list
+  Ipv4Address Reference (Ptr<Node> nd, uint32_t mns_energy, Ipv4Address preHop, Ipv4Address dst);
+  void CheckDecision ();
+  void CheckRerank ();
+  Neighbors * neighbor;
+};
+
+float
+NeighborDecisionTest::ReferenceQ (Neighbors::Neighbor const & nb, uint32_t se, float sv, uint32_t mns_energy, Ipv4Address preHop, Ipv4Address dst)
+{
+  if (nb.m_neighborAddress == preHop || nb.m_neighborAddress == Ipv4Address ("10.1.1.1"))
+    return -1000000;
+  if (nb.m_neighborAddress == dst)
+    return 0;
+  Time cu = Simulator::Now () - nb.timestamp;
+  float r_t = 0.9 * (-1.0 + 0.5 * nb.m_energy / 1000000.0 + 0.5 * 2.0 / 3.1415927 * std::atan ((float)(nb.m_energy - nb.mns_energy) / 1000000.0) + 0.5 * (-1.0 / 50.0 * cu.GetMilliSeconds ()))
+    + 0.1 * (-1.0 + 0.5 * se / 1000000.0 + 0.5 * 2.0 / 3.1415927 * std::atan ((float)(se - mns_energy) / 1000000.0) - 0.5 * 0.8);
+  return r_t + 0.9 * (0.7 * nb.v_value + 0.3 * sv);
+}
+
+Ipv4Address
+NeighborDecisionTest::Reference (Ptr<Node> nd, uint32_t mns_energy, Ipv4Address preHop, Ipv4Address dst)
+{
+  std::vector<Neighbors::Neighbor> list = neighbor->GetNeighborsList ();
+  float nmax = 0;
+  uint32_t idx = 0;
+  for (uint32_t i = 0; i < list.size (); ++i)
+    {
+      float q = ReferenceQ (list[i], nd->GetSelfEnergy (), nd->GetSelfV_value (), mns_energy, preHop, dst);
+      if (list.size () == 1)
+        break;
+      if (i == 0 || q > nmax)
+        {
+          nmax = q;
+          idx = i;
+        }
+    }
+  return list[idx].m_neighborAddress;
+}
+
+void
+NeighborDecisionTest::CheckDecision ()
+{
+  Ptr<Node> nd = CreateObject<Node> ();
+  nd->SetSelfEnergy (800000);
+  nd->SetSelfV_value (0.5);
+  // Fresh hello from 2.2.2.2 makes it the best candidate
+  neighbor->Update (Ipv4Address ("2.2.2.2"), Seconds (5), 950000, 0.2, 0, 900000);
+  // Mean energy of the neighbors, as refreshed when a hello is sent
+  uint32_t mns = neighbor->GetMnsEnergy ();
+  NS_TEST_EXPECT_MSG_EQ (mns, (900000 + 950000 + 990000 + 700000) / 4, "Mean energy of the neighbors");
+  Ipv4Address expected = Reference (nd, mns, Ipv4Address ("4.4.4.4"), Ipv4Address ("9.9.9.9"));
+  NS_TEST_EXPECT_MSG_EQ (expected, Ipv4Address ("2.2.2.2"), "Fresh neighbor wins");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->RouteDecision (nd, Ipv4Address ("4.4.4.4"), Ipv4Address ("9.9.9.9")), expected, "Best Q-value");
+  expected = Reference (nd, mns, Ipv4Address ("2.2.2.2"), Ipv4Address ("9.9.9.9"));
+  NS_TEST_EXPECT_MSG_EQ (neighbor->RouteDecision (nd, Ipv4Address ("2.2.2.2"), Ipv4Address ("9.9.9.9")), expected, "Previous hop excluded");
+  expected = Reference (nd, mns, Ipv4Address ("2.2.2.2"), Ipv4Address ("3.3.3.3"));
+  NS_TEST_EXPECT_MSG_EQ (neighbor->RouteDecision (nd, Ipv4Address ("2.2.2.2"), Ipv4Address ("3.3.3.3")), expected, "Destination scores 0");
+  NS_TEST_EXPECT_MSG_EQ (expected, Ipv4Address ("3.3.3.3"), "Destination preferred over stale neighbors");
+  std::vector<Neighbors::Neighbor> list = neighbor->GetNeighborsList ();
+  NS_TEST_EXPECT_MSG_EQ (list[2].q_value, 0, "Q-value of the destination");
+  NS_TEST_EXPECT_MSG_EQ (list[1].q_value, -1000000, "Q-value of the previous hop");
+  NS_TEST_EXPECT_MSG_EQ (nd->GetSelfV_value (), 0, "V value is the best Q-value");
+}
+
+void
+NeighborDecisionTest::CheckRerank ()
+{
+  Ptr<Node> nd = CreateObject<Node> ();
+  nd->SetSelfEnergy (800000);
+  nd->SetSelfV_value (0.5);
+  neighbor->Update (Ipv4Address ("5.5.5.5"), Seconds (5), 600000, 0.8, 0, 500000);
+  neighbor->Update (Ipv4Address ("6.6.6.6"), Seconds (5), 990000, 0.3, 0, 950000);
+  neighbor->Update (Ipv4Address ("1.1.1.1"), Seconds (5), 970000, 0.6, 0, 900000);
+  // Changes the score of every entry and ranks them all again
+  neighbor->VValueUpdate ();
+  uint32_t mns = neighbor->GetMnsEnergy ();
+  const char * addresses[] = { "1.1.1.1", "2.2.2.2", "3.3.3.3", "4.4.4.4", "5.5.5.5", "6.6.6.6" };
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      Ipv4Address preHop (addresses[i]);
+      Ipv4Address dst (addresses[(i + 3) % 6]);
+      uint32_t se = nd->GetSelfEnergy ();
+      float sv = nd->GetSelfV_value ();
+      Ipv4Address expected = Reference (nd, mns, preHop, dst);
+      NS_TEST_EXPECT_MSG_EQ (neighbor->RouteDecision (nd, preHop, dst), expected, "Same next hop as a full recomputation");
+      std::vector<Neighbors::Neighbor> list = neighbor->GetNeighborsList ();
+      for (uint32_t j = 0; j < list.size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (list[j].q_value, ReferenceQ (list[j], se, sv, mns, preHop, dst), 1e-3,
+                                     "Same Q-value as a full recomputation for " << list[j].m_neighborAddress);
+        }
+    }
+}
+
+void
+NeighborDecisionTest::DoRun ()
+{
+  Neighbors nb (Seconds (10));
+  neighbor = &nb;
+  neighbor->Update (Ipv4Address ("1.1.1.1"), Seconds (5), 900000, 0.1, 0, 800000);
+  neighbor->Update (Ipv4Address ("2.2.2.2"), Seconds (5), 950000, 0.2, 0, 900000);
+  neighbor->Update (Ipv4Address ("3.3.3.3"), Seconds (5), 990000, 0.0, 0, 1000000);
+  neighbor->Update (Ipv4Address ("4.4.4.4"), Seconds (5), 700000, 0.9, 0, 600000);
+  Simulator::Schedule (Seconds (2), &NeighborDecisionTest::CheckDecision, this);
+  Simulator::Schedule (Seconds (3), &NeighborDecisionTest::CheckRerank, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Neighbors empty (Seconds (10));
+  Ptr<Node> nd = CreateObject<Node> ();
+  NS_TEST_EXPECT_MSG_EQ (empty.RouteDecision (nd, Ipv4Address ("2.2.2.2"), Ipv4Address ("3.3.3.3")), Ipv4Address (),
+                         "No next hop without neighbors");
+}
+//-----------------------------------------------------------------------------
 struct TypeHeaderTest : public TestCase
 {
   TypeHeaderTest () : TestCase ("AODV TypeHeader") 
@@ -520,12 +703,78 @@ struct AodvRtableTest : public TestCase
   }
 };
 //-----------------------------------------------------------------------------
+/// Unit test for the next hop and lifetime indexes of the routing table
+struct AodvRtableIndexTest : public TestCase
+{
+  AodvRtableIndexTest () : TestCase ("Rtable indexes"), rtable (Seconds (2)) {}
+  virtual void DoRun ();
+  /// Check destinations reached through nextHop
+  void CheckNextHop (Ipv4Address nextHop, uint32_t count);
+  void CheckExpiry ();
+  RoutingTable rtable;
+};
+
+void
+AodvRtableIndexTest::CheckNextHop (Ipv4Address nextHop, uint32_t count)
+{
+  std::map<Ipv4Address, uint32_t> unreachable;
+  rtable.GetListOfDestinationWithNextHop (nextHop, unreachable);
+  NS_TEST_EXPECT_MSG_EQ (unreachable.size (), count, "Destinations through " << nextHop);
+}
+
+void
+AodvRtableIndexTest::CheckExpiry ()
+{
+  RoutingTableEntry rt;
+  // 1.0.0.1 and 1.0.0.2 expired at 1 s and were invalidated, 1.0.0.3 expired too but is deleted
+  NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("1.0.0.1"), rt), true, "Expired route kept");
+  NS_TEST_EXPECT_MSG_EQ (rt.GetFlag (), INVALID, "Expired route invalidated");
+  NS_TEST_EXPECT_MSG_EQ (rt.GetLifeTime (), Seconds (2), "Invalid route lives for BadLinkLifetime");
+  NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("1.0.0.3"), rt), false, "Expired invalid route deleted");
+  NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("1.0.0.4"), rt), true, "Live route kept");
+  NS_TEST_EXPECT_MSG_EQ (rt.GetFlag (), VALID, "Live route kept");
+  CheckNextHop (Ipv4Address ("10.0.0.1"), 1);
+  CheckNextHop (Ipv4Address ("10.0.0.2"), 2);
+}
+
+void
+AodvRtableIndexTest::DoRun ()
+{
+  Ptr<NetDevice> dev;
+  Ipv4InterfaceAddress iface;
+  for (uint32_t i = 1; i <= 4; ++i)
+    {
+      RoutingTableEntry rt (dev, Ipv4Address (0x01000000 + i), true, i, iface, 2,
+                            Ipv4Address ("10.0.0.1"), Seconds (i < 4 ? 1 : 10));
+      rtable.AddRoute (rt);
+    }
+  CheckNextHop (Ipv4Address ("10.0.0.1"), 4);
+  // The route object is shared with the table, Update moves the entry in the index
+  RoutingTableEntry rt;
+  rtable.LookupRoute (Ipv4Address ("1.0.0.2"), rt);
+  rt.SetNextHop (Ipv4Address ("10.0.0.2"));
+  rtable.Update (rt);
+  rtable.LookupRoute (Ipv4Address ("1.0.0.4"), rt);
+  rt.SetNextHop (Ipv4Address ("10.0.0.2"));
+  rtable.Update (rt);
+  CheckNextHop (Ipv4Address ("10.0.0.1"), 2);
+  CheckNextHop (Ipv4Address ("10.0.0.2"), 2);
+  rtable.SetEntryState (Ipv4Address ("1.0.0.3"), INVALID);
+  Simulator::Schedule (Seconds (2), &AodvRtableIndexTest::CheckExpiry, this);
+  Simulator::Run ();
+  rtable.Clear ();
+  CheckNextHop (Ipv4Address ("10.0.0.2"), 0);
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
 class AodvTestSuite : public TestSuite
 {
 public:
   AodvTestSuite () : TestSuite ("routing-aodv", UNIT)
   {
     AddTestCase (new NeighborTest, TestCase::QUICK);
+    AddTestCase (new NeighborPurgeTest, TestCase::QUICK);
+    AddTestCase (new NeighborDecisionTest, TestCase::QUICK);
     AddTestCase (new TypeHeaderTest, TestCase::QUICK);
     AddTestCase (new RreqHeaderTest, TestCase::QUICK);
     AddTestCase (new RrepHeaderTest, TestCase::QUICK);
@@ -535,6 +784,7 @@ public:
     AddTestCase (new AodvRqueueTest, TestCase::QUICK);
     AddTestCase (new AodvRtableEntryTest, TestCase::QUICK);
     AddTestCase (new AodvRtableTest, TestCase::QUICK);
+    AddTestCase (new AodvRtableIndexTest, TestCase::QUICK);
   }
 } g_aodvTestSuite;
 
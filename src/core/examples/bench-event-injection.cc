@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <time.h>
+
+/**
+ * \file
+ * Stress test of Simulator::ScheduleWithContext called by other threads
+ * than the simulation thread, as done by emulated and fd net devices.
+ *
+ * Producer threads inject events with a null delay as fast as they can;
+ * each event carries the wall clock time of its injection. The benchmark
+ * reports the injected events per second and the percentiles of the
+ * latency between the injection and the execution of the events.
+ */
+
+using namespace ns3;
+
+/** \returns The monotonic wall clock, in ns. */
+static uint64_t
+WallClock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** State shared by the producers and the simulation thread. */
+class Injection
+{
+public:
+  Injection (uint32_t threads, uint32_t events)
+    : m_threads (threads),
+      m_events (events),
+      m_done (false)
+  {
+    m_latencies.reserve ((std::size_t) threads * events);
+  }
+  /**
+   * Inject the events of a producer.
+   *
+   * \param [in] context The benchmark and the producer index.
+   */
+  static void Produce (std::pair<Injection *, uint32_t> context)
+  {
+    Injection *me = context.first;
+    for (uint32_t i = 0; i < me->m_events; i++)
+      {
+        Simulator::ScheduleWithContext (context.second, Seconds (0), &Injection::Receive, me, WallClock ());
+      }
+  }
+  /**
+   * Record the latency of an injected event.
+   *
+   * \param [in] injected The wall clock time of the injection.
+   */
+  void Receive (uint64_t injected)
+  {
+    m_latencies.push_back (WallClock () - injected);
+    if (m_latencies.size () == (std::size_t) m_threads * m_events)
+      {
+        m_done = true;
+        Simulator::Stop ();
+      }
+  }
+  /**
+   * Keep the simulator running until all events are received.  Only
+   * needed by the implementations which return from Run when they have
+   * no event, unlike RealtimeSimulatorImpl.
+   */
+  void KeepAlive (void)
+  {
+    if (!m_done)
+      {
+        Simulator::Schedule (NanoSeconds (1), &Injection::KeepAlive, this);
+      }
+  }
+
+  uint32_t m_threads;
+  uint32_t m_events;
+  bool m_done;
+  std::vector<uint64_t> m_latencies;
+};
+
+/**
+ * Run the benchmark on a simulator implementation.
+ *
+ * \param [in] type The SimulatorImpl TypeId name.
+ * \param [in] threads The number of producer threads.
+ * \param [in] events The number of events injected by each thread.
+ */
+static void
+Run (std::string type, uint32_t threads, uint32_t events)
+{
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (type));
+  Injection injection (threads, events);
+  // Creates the implementation on this thread
+  Simulator::Now ();
+  if (type != "ns3::RealtimeSimulatorImpl")
+    {
+      Simulator::Schedule (Seconds (0), &Injection::KeepAlive, &injection);
+    }
+
+  std::vector<Ptr<SystemThread> > producers;
+  for (uint32_t t = 0; t < threads; t++)
+    {
+      producers.push_back (Create<SystemThread> (MakeBoundCallback (&Injection::Produce, std::make_pair (&injection, t))));
+    }
+  uint64_t start = WallClock ();
+  for (uint32_t t = 0; t < threads; t++)
+    {
+      producers[t]->Start ();
+    }
+  Simulator::Run ();
+  uint64_t end = WallClock ();
+  for (uint32_t t = 0; t < threads; t++)
+    {
+      producers[t]->Join ();
+    }
+  Simulator::Destroy ();
+
+  std::vector<uint64_t> &latencies = injection.m_latencies;
+  std::sort (latencies.begin (), latencies.end ());
+  std::size_t n = latencies.size ();
+  std::cout << type.substr (5) << "\t" << threads
+            << "\t" << std::fixed << std::setprecision (0) << n * 1e9 / (end - start)
+            << std::setprecision (1)
+            << "\t" << latencies[n / 2] / 1e3
+            << "\t" << latencies[n * 99 / 100] / 1e3
+            << "\t" << latencies[n * 999 / 1000] / 1e3
+            << "\t" << latencies[n - 1] / 1e3
+            << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string threads = "1,2,4,8";
+  uint32_t events = 200000;
+  std::string simulators = "ns3::DefaultSimulatorImpl,ns3::RealtimeSimulatorImpl";
+
+  CommandLine cmd;
+  cmd.AddValue ("threads", "Comma separated numbers of producer threads", threads);
+  cmd.AddValue ("events", "Events injected by each producer thread", events);
+  cmd.AddValue ("simulators", "Comma separated simulator implementations", simulators);
+  cmd.Parse (argc, argv);
+
+  std::cout << "simulator\tthreads\tevents/s\tp50 us\tp99 us\tp99.9 us\tmax us" << std::endl;
+  std::istringstream types (simulators);
+  std::string type;
+  while (std::getline (types, type, ','))
+    {
+      std::istringstream counts (threads);
+      std::string count;
+      while (std::getline (counts, count, ','))
+        {
+          Run (type, std::atoi (count.c_str ()), events);
+        }
+    }
+  return 0;
+}
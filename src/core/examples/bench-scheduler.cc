@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Hold model benchmark of the event schedulers.
+ */
+
+#include "ns3/core-module.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Source of event delays, in dimensionless time units.
+ *
+ * The delays are drawn before the measurement starts so that the
+ * benchmark only times the scheduler.
+ */
+class DelayMix
+{
+public:
+  /**
+   * \param [in] name The distribution name.
+   * \param [in] count The number of delays to draw, a power of two.
+   */
+  DelayMix (std::string name, uint32_t count)
+    : m_name (name),
+      m_next (0)
+  {
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+    Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+    exponential->SetAttribute ("Mean", DoubleValue (100));
+    for (uint32_t i = 0; i < count; i++)
+      {
+        double delay;
+        if (name == "exponential")
+          {
+            delay = exponential->GetValue ();
+          }
+        else if (name == "uniform")
+          {
+            delay = uniform->GetValue (0, 200);
+          }
+        else if (name == "bimodal")
+          {
+            // Mostly short delays with a few a hundred times longer
+            delay = uniform->GetValue () < 0.9 ? uniform->GetValue (0, 2) : uniform->GetValue (100, 200);
+          }
+        else
+          {
+            // Wifi backoff slots, same time events and AODV timers, in us
+            double kind = uniform->GetValue ();
+            delay = kind < 0.3 ? 0 : kind < 0.9 ? 9 * uniform->GetInteger (0, 31) : uniform->GetValue (1e6, 3e6);
+          }
+        m_delays.push_back ((uint64_t) delay);
+      }
+  }
+  std::string GetName (void) const { return m_name; }
+  uint64_t Next (void)
+  {
+    m_next = (m_next + 1) & (m_delays.size () - 1);
+    return m_delays[m_next];
+  }
+
+private:
+  std::string m_name;
+  std::vector<uint64_t> m_delays;
+  uint32_t m_next;
+};
+
+/**
+ * Run the hold model: fill the scheduler with \p population events, then
+ * repeatedly remove the earliest event and insert a new one at its time
+ * plus a delay.
+ *
+ * \param [in] type The scheduler TypeId name.
+ * \param [in] population The number of pending events.
+ * \param [in] holds The number of hold operations.
+ * \param [in] mix The delays.
+ * \returns The wall clock time per hold operation, in ns.
+ */
+static double
+Hold (std::string type, uint32_t population, uint32_t holds, DelayMix &mix)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < population; i++)
+    {
+      Scheduler::Event ev = { 0, { mix.Next (), uid++, 0 } };
+      scheduler->Insert (ev);
+    }
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < holds; i++)
+    {
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_ABORT_MSG_IF (next.key.m_ts < now, type << " returned events out of order");
+      now = next.key.m_ts;
+      Scheduler::Event ev = { 0, { now + mix.Next (), uid++, 0 } };
+      scheduler->Insert (ev);
+    }
+  int64_t ms = clock.End ();
+  return ms * 1e6 / holds;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minPopulation = 100;
+  uint32_t maxPopulation = 1000000;
+  uint32_t holds = 1000000;
+  uint32_t maxListPopulation = 10000;
+  std::string mixes = "exponential,uniform,bimodal,wifi";
+
+  CommandLine cmd;
+  cmd.AddValue ("minPopulation", "Smallest number of pending events", minPopulation);
+  cmd.AddValue ("maxPopulation", "Largest number of pending events, multiplied by 10 from minPopulation", maxPopulation);
+  cmd.AddValue ("holds", "Hold operations per run", holds);
+  cmd.AddValue ("maxListPopulation", "Largest number of pending events for ns3::ListScheduler", maxListPopulation);
+  cmd.AddValue ("mixes", "Comma separated delay distributions: exponential, uniform, bimodal, wifi", mixes);
+  cmd.Parse (argc, argv);
+
+  const char *types[] = { "ns3::ListScheduler", "ns3::MapScheduler", "ns3::HeapScheduler",
+                          "ns3::CalendarScheduler", "ns3::LadderScheduler" };
+  uint32_t nTypes = sizeof (types) / sizeof (types[0]);
+
+  std::string::size_type start = 0;
+  while (start < mixes.size ())
+    {
+      std::string::size_type end = mixes.find (',', start);
+      if (end == std::string::npos)
+        {
+          end = mixes.size ();
+        }
+      DelayMix mix (mixes.substr (start, end - start), 1 << 20);
+      start = end + 1;
+
+      std::cout << mix.GetName () << " delays, ns per hold" << std::endl << "events";
+      for (uint32_t t = 0; t < nTypes; t++)
+        {
+          std::cout << "\t" << std::string (types[t]).substr (5);
+        }
+      std::cout << std::endl;
+      for (uint32_t n = minPopulation; n <= maxPopulation; n *= 10)
+        {
+          std::cout << n;
+          for (uint32_t t = 0; t < nTypes; t++)
+            {
+              std::cout << "\t";
+              if (t == 0 && n > maxListPopulation)
+                {
+                  std::cout << "-";
+                  continue;
+                }
+              std::cout << std::setprecision (4) << Hold (types[t], n, holds, mix);
+            }
+          std::cout << std::endl;
+        }
+      std::cout << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the creation, copy and arithmetic of Time values.
+ *
+ * Run it in a build configured with and without --fixed-time-resolution
+ * to compare.  The copy and arithmetic loops are timed both before
+ * Simulator::Run, while the instances of Time are still recorded for
+ * Time::SetResolution, and from an event.
+ */
+
+#include "ns3/core-module.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/** Copy and sort a vector of Time, like an event list would. */
+double
+Copy (const std::vector<Time> &times)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  std::vector<Time> copy (times);
+  std::sort (copy.begin (), copy.end ());
+  int64_t ms = clock.End ();
+  NS_ABORT_IF (copy.front () > copy.back ());
+  return ms * 1e6 / times.size ();
+}
+
+/** Sum and compare Time values, through temporaries. */
+double
+Arithmetic (const std::vector<Time> &times, uint32_t rounds)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  Time sum;
+  Time max;
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (std::vector<Time>::const_iterator i = times.begin (); i != times.end (); ++i)
+        {
+          sum = sum + *i / 2 - MicroSeconds (1);
+          max = Max (max, *i + TimeStep (r));
+        }
+    }
+  int64_t ms = clock.End ();
+  NS_ABORT_IF (sum.IsZero () && max.IsZero ());
+  return ms * 1e6 / (times.size () * rounds);
+}
+
+/** Print the result of a loop. */
+void
+Print (const char *loop, const char *when, double ns)
+{
+  std::cout << std::left << std::setw (12) << loop << std::setw (14) << when
+            << std::right << std::setw (10) << std::setprecision (4) << ns << std::endl;
+}
+
+/** The Time values used by the loops. */
+std::vector<Time> g_times;
+/** Outer iterations of the arithmetic loop. */
+uint32_t g_rounds;
+
+/** Time the loops once the simulation has started. */
+void
+RunLoops (void)
+{
+  Print ("copy", "during Run", Copy (g_times));
+  Print ("arithmetic", "during Run", Arithmetic (g_times, g_rounds));
+}
+
+/** Number of events left to run in the chain. */
+uint32_t g_events;
+/** Shortest delay of the events of the chain. */
+Time g_delay;
+
+/** One event of the chain, which schedules the next one. */
+void
+Chain (void)
+{
+  if (--g_events > 0)
+    {
+      Simulator::Schedule (g_delay + TimeStep (g_events % 16), &Chain);
+    }
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t count = 1000000;
+  uint32_t rounds = 10;
+  uint32_t events = 5000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("count", "Number of Time values copied and summed", count);
+  cmd.AddValue ("rounds", "Iterations of the arithmetic loop", rounds);
+  cmd.AddValue ("events", "Number of events of the chain", events);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < count; i++)
+    {
+      g_times.push_back (NanoSeconds (uniform->GetInteger (0, 1000000)));
+    }
+  g_rounds = rounds;
+
+  std::cout << "Time resolution ";
+#ifdef NS3_FIXED_TIME_RESOLUTION
+  std::cout << "fixed";
+#else
+  std::cout << "variable";
+#endif
+  std::cout << ", ns per operation" << std::endl;
+  Print ("copy", "before Run", Copy (g_times));
+  Print ("arithmetic", "before Run", Arithmetic (g_times, rounds));
+
+  Simulator::ScheduleNow (&RunLoops);
+  Simulator::Run ();
+
+  g_events = events;
+  g_delay = NanoSeconds (1);
+  Simulator::Schedule (g_delay, &Chain);
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t ms = clock.End ();
+  Print ("event chain", "", ms * 1e6 / events);
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "fatal-impl.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace {
+
+/** Index of the branch running in this process. */
+uint32_t g_branch = Checkpoint::PARENT;
+/** Processes forked by this process and not waited for yet. */
+std::vector<pid_t> g_children;
+
+/** Flush the buffered output, which the branches would write again. */
+void
+FlushAll (void)
+{
+  LogFlush ();
+  // The pcap and ascii trace files
+  FatalImpl::FlushRegisteredStreams ();
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (NULL);
+}
+
+} // unnamed namespace
+
+uint32_t
+Checkpoint::Fork (uint32_t branches)
+{
+  NS_LOG_FUNCTION (branches << Simulator::Now ());
+  FlushAll ();
+  for (uint32_t i = 0; i < branches; i++)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Cannot fork branch " << i << ": " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_branch = i;
+          g_children.clear ();
+          return i;
+        }
+      NS_LOG_LOGIC ("branch " << i << " is process " << pid);
+      g_children.push_back (pid);
+    }
+  Simulator::Stop ();
+  return PARENT;
+}
+
+bool
+Checkpoint::IsBranch (void)
+{
+  return g_branch != PARENT;
+}
+
+uint32_t
+Checkpoint::GetBranch (void)
+{
+  return g_branch;
+}
+
+uint32_t
+Checkpoint::Wait (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t failed = 0;
+  for (std::vector<pid_t>::const_iterator i = g_children.begin (); i != g_children.end (); ++i)
+    {
+      int status;
+      pid_t pid;
+      do
+        {
+          pid = waitpid (*i, &status, 0);
+        }
+      while (pid < 0 && errno == EINTR);
+      if (pid < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("branch process " << *i << " failed");
+          failed++;
+        }
+    }
+  g_children.clear ();
+  return failed;
+}
+
+void
+Checkpoint::Exit (int status)
+{
+  NS_LOG_FUNCTION (status);
+  FlushAll ();
+  _exit (status);
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Continue a simulation in several branches from its current state.
+ *
+ * Fork duplicates the simulation process: each branch starts with the
+ * exact state of the simulation at the time of the call, that is the
+ * pending events, the state of every model and the position of every
+ * random number stream, and may then change parameters before going on.
+ * This lets many what-if runs share one warm-up:
+ *
+ * \code
+ *   void
+ *   Branch (void)
+ *   {
+ *     uint32_t branch = Checkpoint::Fork (3);
+ *     if (branch != Checkpoint::PARENT)
+ *       {
+ *         Config::Set ("/NodeList/0/...", ...values[branch]...);
+ *       }
+ *   }
+ *
+ *   Simulator::Schedule (Seconds (3600), &Branch);
+ *   Simulator::Run ();
+ *   if (Checkpoint::IsBranch ())
+ *     {
+ *       // write the results of the branch
+ *       Simulator::Destroy ();
+ *       Checkpoint::Exit (0);
+ *     }
+ *   uint32_t failed = Checkpoint::Wait ();
+ * \endcode
+ *
+ * The parent process stops its simulation when it forks and Wait returns
+ * once all branches have exited.  The standard streams, the buffered
+ * logging output and the trace files registered with
+ * FatalImpl::RegisterStream, such as pcap and ascii traces, are flushed
+ * before the fork, so that the branches do not write the output of the
+ * parent again; the background writer of the trace files enabled by
+ * "AsyncTraceBufferSize" is drained before the fork and restarted in each
+ * branch.  These files stay shared by all branches after the fork:
+ * a branch should open its own outputs.  Only the thread calling Fork
+ * exists in the branches, so this is not supported by the realtime
+ * simulator implementation while its threads are running.
+ *
+ * The branches only live in memory, as copies of the running process.
+ * Saving the state to a file, to resume it in a later run with new
+ * parameters, is deliberately out of scope: the pending events are
+ * closures over arbitrary model objects, and most model state cannot be
+ * reached through attributes, so it cannot be serialized faithfully.
+ */
+class Checkpoint
+{
+public:
+  /** Branch index returned by Fork in the parent process. */
+  static const uint32_t PARENT = 0xffffffff;
+
+  /**
+   * Fork the simulation.  Must be called from an event, or between two
+   * calls to Simulator::Run.
+   *
+   * \param [in] branches The number of branches.
+   * \returns The branch index, from 0 to \p branches - 1, in the new
+   *   processes, and PARENT in the calling process whose simulation is
+   *   stopped.
+   */
+  static uint32_t Fork (uint32_t branches);
+  /** \returns \c true in the processes created by Fork. */
+  static bool IsBranch (void);
+  /**
+   * \returns The index of the branch running in this process, or PARENT
+   *   in the process which called Fork.
+   */
+  static uint32_t GetBranch (void);
+  /**
+   * Wait for the branches forked by this process.
+   *
+   * \returns The number of branches which did not exit with status 0.
+   */
+  static uint32_t Wait (void);
+  /**
+   * Terminate a branch without running the exit handlers of the parent
+   * process, after flushing the standard streams.
+   *
+   * \param [in] status The exit status of the branch.
+   */
+  static void Exit (int status);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
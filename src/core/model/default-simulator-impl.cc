@@ -27,8 +27,10 @@
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "string.h"
 
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,6 +55,14 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileOutput",
+                   "Prefix of the event profile files written at Simulator::Destroy: "
+                   "the handlers sorted by wall clock time in <prefix>.txt and the "
+                   "input of flamegraph.pl in <prefix>.folded.  Empty to disable "
+                   "event profiling.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetProfileOutput),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -71,13 +81,14 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -108,6 +119,49 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      WriteProfile ();
+    }
+}
+
+void
+DefaultSimulatorImpl::SetProfileOutput (std::string output)
+{
+  NS_LOG_FUNCTION (this << output);
+  m_profileOutput = output;
+  if (output.empty ())
+    {
+      delete m_profiler;
+      m_profiler = 0;
+    }
+  else if (m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::string filename = m_profileOutput + ".txt";
+  std::ofstream report (filename.c_str ());
+  if (!report.is_open ())
+    {
+      NS_LOG_WARN ("Cannot write event profile " << filename);
+      return;
+    }
+  m_profiler->Print (report);
+
+  filename = m_profileOutput + ".folded";
+  std::ofstream folded (filename.c_str ());
+  if (!folded.is_open ())
+    {
+      NS_LOG_WARN ("Cannot write event profile " << filename);
+      return;
+    }
+  m_profiler->PrintFolded (folded);
 }
 
 void
@@ -146,7 +200,16 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Start (next.impl, next.key.m_uid, next.key.m_ts, next.key.m_context);
+      next.impl->Invoke ();
+      m_profiler->End ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -161,31 +224,30 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.IsEmpty ())
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  m_eventsWithContext.Drain (m_injected);
+  for (std::vector<EventInjectionQueue::Entry>::const_iterator i = m_injected.begin ();
+       i != m_injected.end (); ++i)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = i->event;
+       // Current time added here, the entry holds the delay
+       ev.key.m_ts = m_currentTs + i->ts;
+       ev.key.m_context = i->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       if (m_profiler != 0)
+         {
+           m_profiler->Scheduled (ev.key.m_uid, m_currentTs);
+         }
     }
+  m_injected.clear ();
 }
 
 void
@@ -242,6 +304,10 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_profiler != 0)
+    {
+      m_profiler->Scheduled (ev.key.m_uid, m_currentTs);
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -261,19 +327,19 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_profiler != 0)
+        {
+          m_profiler->Scheduled (ev.key.m_uid, m_currentTs);
+        }
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      EventInjectionQueue::Entry entry;
+      entry.event = event;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      entry.ts = delay.GetTimeStep ();
+      entry.context = context;
+      m_eventsWithContext.Push (entry);
     }
 }
 
@@ -290,6 +356,10 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_profiler != 0)
+    {
+      m_profiler->Scheduled (ev.key.m_uid, m_currentTs);
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -350,6 +420,10 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
   m_events->Remove (event);
+  if (m_profiler != 0)
+    {
+      m_profiler->Removed (event.key.m_uid);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
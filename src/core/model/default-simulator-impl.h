@@ -24,12 +24,16 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-injection-queue.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -43,6 +47,10 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * Setting the ProfileOutput attribute attributes the wall clock time of
+ * the events to their handlers with an EventProfiler, and writes its
+ * reports at Simulator::Destroy.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -85,27 +93,19 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
- 
-  /** Wrap an event with its execution context. */
-  struct EventWithContext {
-    /** The event context. */
-    uint32_t context;
-    /** Event timestamp. */
-    uint64_t timestamp;
-    /** The event implementation. */
-    EventImpl *event;
-  };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * Enable the event profiler.
+   *
+   * \param [in] output The prefix of the report files, empty to disable.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  void SetProfileOutput (std::string output);
+  /** Write the reports of the event profiler. */
+  void WriteProfile (void) const;
+ 
+  /** Events scheduled with context by other threads. */
+  EventInjectionQueue m_eventsWithContext;
+  /** Events drained from m_eventsWithContext, kept to reuse its storage. */
+  std::vector<EventInjectionQueue::Entry> m_injected;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -132,6 +132,11 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event profiler, null when disabled. */
+  EventProfiler *m_profiler;
+  /** Prefix of the event profiler reports. */
+  std::string m_profileOutput;
 };
 
 } // namespace ns3
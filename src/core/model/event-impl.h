@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include "simple-ref-count.h"
+#include "event-pool.h"
 
 /**
  * \file
@@ -48,6 +49,26 @@ public:
   EventImpl ();
   /** Destructor. */
   virtual ~EventImpl () = 0;
+  /**
+   * Allocate an event from the EventPool of the calling thread.
+   *
+   * \param [in] size The size of the event subclass.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return EventPool::Allocate (size);
+  }
+  /**
+   * Return an event to the EventPool of the calling thread.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event subclass.
+   */
+  static void operator delete (void *p, std::size_t size)
+  {
+    EventPool::Deallocate (p, size);
+  }
   /**
    * Called by the simulation engine to notify the event that it is time
    * to execute.
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-injection-queue.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventInjectionQueue implementation.
+ *
+ * The ring follows the bounded queue of Dmitry Vyukov: each slot holds
+ * the position it expects next, so that producers claim positions with a
+ * compare and swap on the tail and the consumer finds published entries
+ * without touching the tail.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventInjectionQueue");
+
+EventInjectionQueue::EventInjectionQueue (uint32_t capacity)
+  : m_tail (0),
+    m_head (0),
+    m_overflowing (0),
+    m_overflows (0)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  uint64_t size = 2;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_mask = size - 1;
+  m_cells = new Cell [size];
+  for (uint64_t i = 0; i < size; i++)
+    {
+      m_cells[i].sequence = i;
+    }
+}
+
+EventInjectionQueue::~EventInjectionQueue ()
+{
+  NS_LOG_FUNCTION (this);
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+void
+EventInjectionQueue::Push (const Entry &entry)
+{
+  if (m_overflowing == 0)
+    {
+      uint64_t pos = m_tail;
+      for (;;)
+        {
+          Cell *cell = &m_cells[pos & m_mask];
+          int64_t diff = (int64_t)(cell->sequence - pos);
+          if (diff == 0)
+            {
+              if (__sync_bool_compare_and_swap (&m_tail, pos, pos + 1))
+                {
+                  cell->entry = entry;
+                  // The entry must be visible before the slot is published
+                  __sync_synchronize ();
+                  cell->sequence = pos + 1;
+                  return;
+                }
+              pos = m_tail;
+            }
+          else if (diff < 0)
+            {
+              // The consumer has not freed this slot yet: the ring is full
+              break;
+            }
+          else
+            {
+              // Another producer claimed this position
+              pos = m_tail;
+            }
+        }
+    }
+  CriticalSection cs (m_overflowMutex);
+  m_overflow.push_back (entry);
+  m_overflowing = 1;
+  m_overflows++;
+}
+
+uint32_t
+EventInjectionQueue::Drain (std::vector<Entry> &entries)
+{
+  uint32_t n = 0;
+  for (;;)
+    {
+      Cell *cell = &m_cells[m_head & m_mask];
+      if (cell->sequence != m_head + 1)
+        {
+          // Empty, or claimed by a producer which has not published yet
+          break;
+        }
+      __sync_synchronize ();
+      entries.push_back (cell->entry);
+      // The entry must be read before the slot is given back
+      __sync_synchronize ();
+      cell->sequence = m_head + m_mask + 1;
+      m_head++;
+      n++;
+    }
+  // Entries of the overflow list were pushed after every claimed slot of
+  // the ring; take them only once the ring is empty to keep their order.
+  if (m_overflowing != 0 && m_head == m_tail)
+    {
+      CriticalSection cs (m_overflowMutex);
+      entries.insert (entries.end (), m_overflow.begin (), m_overflow.end ());
+      n += m_overflow.size ();
+      m_overflow.clear ();
+      m_overflowing = 0;
+    }
+  NS_LOG_LOGIC ("drained " << n << " entries");
+  return n;
+}
+
+bool
+EventInjectionQueue::IsEmpty (void) const
+{
+  return m_head == m_tail && m_overflowing == 0;
+}
+
+uint64_t
+EventInjectionQueue::GetOverflows (void) const
+{
+  return m_overflows;
+}
+
+} // namespace ns3
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_INJECTION_QUEUE_H
+#define EVENT_INJECTION_QUEUE_H
+
+#include "system-mutex.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventInjectionQueue declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Queue of the events scheduled by other threads than the
+ * simulation thread.
+ *
+ * Any number of threads may Push; only the simulation thread may Drain.
+ * Push claims a slot of a fixed size ring with a single compare and swap
+ * and never blocks on the simulation thread. Drain moves every published
+ * entry out in one batch, so the simulation thread pays one check per
+ * event when nothing was injected.
+ *
+ * When the ring is full, entries go to an overflow list protected by a
+ * mutex until the simulation thread has drained the ring, so the queue is
+ * unbounded and the entries of each producer thread keep their order.
+ */
+class EventInjectionQueue
+{
+public:
+  /** An injected event. */
+  struct Entry
+  {
+    EventImpl *event;  /**< The event. */
+    uint64_t ts;       /**< Timestamp, interpreted by the simulator. */
+    uint32_t context;  /**< Context of the event. */
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The number of slots of the ring, rounded up to a
+   *   power of two.
+   */
+  EventInjectionQueue (uint32_t capacity = 1024);
+  /** Destructor. */
+  ~EventInjectionQueue ();
+
+  /**
+   * Add an entry.  May be called by any thread.
+   *
+   * \param [in] entry The entry.
+   */
+  void Push (const Entry &entry);
+  /**
+   * Move the pending entries to the end of a vector.  Must only be called
+   * by one thread at a time.
+   *
+   * \param [in,out] entries The vector receiving the entries, in push
+   *   order for each producer thread.
+   * \returns The number of entries moved.
+   */
+  uint32_t Drain (std::vector<Entry> &entries);
+  /**
+   * \returns \c true if no entry was pushed since the last Drain.  This is
+   *   only a hint when other threads are pushing.
+   */
+  bool IsEmpty (void) const;
+  /** \returns The number of entries which went to the overflow list. */
+  uint64_t GetOverflows (void) const;
+
+private:
+  /** A slot of the ring. */
+  struct Cell
+  {
+    /**
+     * Position the slot is waiting for: equal to the position when free,
+     * to the position plus one when published.
+     */
+    volatile uint64_t sequence;
+    Entry entry;  /**< The entry, valid when published. */
+  };
+
+  /** Copy constructor, not implemented. */
+  EventInjectionQueue (const EventInjectionQueue &);
+  /** Assignment, not implemented. \returns The queue. */
+  EventInjectionQueue & operator = (const EventInjectionQueue &);
+
+  /** The ring. */
+  Cell *m_cells;
+  /** Capacity minus one. */
+  uint64_t m_mask;
+  /** Padding to keep the positions on their own cache lines. */
+  char m_pad0[64];
+  /** Next position claimed by a producer. */
+  volatile uint64_t m_tail;
+  /** Padding between the producer and consumer positions. */
+  char m_pad1[64];
+  /** Next position read by the consumer. */
+  uint64_t m_head;
+  /** Set while the overflow list holds entries. */
+  volatile uint32_t m_overflowing;
+  /** Entries pushed while the ring was full. */
+  std::vector<Entry> m_overflow;
+  /** Protects m_overflow. */
+  SystemMutex m_overflowMutex;
+  /** Number of entries which went to the overflow list. */
+  uint64_t m_overflows;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_INJECTION_QUEUE_H */
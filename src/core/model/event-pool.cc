@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-pool.h"
+#include "log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventPool implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventPool");
+
+namespace {
+
+/** A free block, linked through its first bytes. */
+struct FreeBlock
+{
+  FreeBlock *next; /**< The next free block of the same size class. */
+};
+
+/** The free lists and counters of a thread. */
+struct Pool
+{
+  FreeBlock *free[EventPool::N_CLASSES]; /**< Free lists, by size class. */
+  uint32_t count[EventPool::N_CLASSES];  /**< Length of the free lists. */
+  EventPool::Stats stats;                /**< Counters. */
+};
+
+/**
+ * Return the free blocks of a pool to operator delete.
+ *
+ * \param [in] pool The pool.
+ */
+void
+ReleasePool (Pool *pool)
+{
+  NS_LOG_FUNCTION (pool << pool->stats.hits << pool->stats.misses);
+  for (std::size_t c = 0; c < EventPool::N_CLASSES; c++)
+    {
+      while (pool->free[c] != 0)
+        {
+          FreeBlock *block = pool->free[c];
+          pool->free[c] = block->next;
+          ::operator delete (block);
+        }
+      pool->count[c] = 0;
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/** Key of the pool of each thread. */
+pthread_key_t g_poolKey;
+/** Creates g_poolKey on first use. */
+pthread_once_t g_poolKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Destroy the pool of an exiting thread.
+ *
+ * \param [in] pool The pool.
+ */
+extern "C" void
+DestroyPool (void *pool)
+{
+  ReleasePool (static_cast<Pool *> (pool));
+  delete static_cast<Pool *> (pool);
+}
+
+/** Create g_poolKey. */
+extern "C" void
+CreatePoolKey (void)
+{
+  pthread_key_create (&g_poolKey, &DestroyPool);
+}
+
+/**
+ * Get the pool of the calling thread.
+ *
+ * \returns The pool.
+ */
+inline Pool *
+GetPool (void)
+{
+  pthread_once (&g_poolKeyOnce, &CreatePoolKey);
+  Pool *pool = static_cast<Pool *> (pthread_getspecific (g_poolKey));
+  if (pool == 0)
+    {
+      pool = new Pool ();
+      pthread_setspecific (g_poolKey, pool);
+    }
+  return pool;
+}
+
+#else /* HAVE_PTHREAD_H */
+
+/**
+ * Get the pool of the calling thread.
+ *
+ * \returns The pool.
+ */
+inline Pool *
+GetPool (void)
+{
+  static Pool pool;
+  return &pool;
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+} // unnamed namespace
+
+void *
+EventPool::Allocate (std::size_t size)
+{
+  std::size_t c = (size - 1) / GRANULARITY;
+  Pool *pool = GetPool ();
+  if (size == 0 || c >= N_CLASSES)
+    {
+      pool->stats.misses++;
+      return ::operator new (size);
+    }
+  FreeBlock *block = pool->free[c];
+  if (block == 0)
+    {
+      pool->stats.misses++;
+      return ::operator new ((c + 1) * GRANULARITY);
+    }
+  pool->free[c] = block->next;
+  pool->count[c]--;
+  pool->stats.hits++;
+  return block;
+}
+
+void
+EventPool::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t c = (size - 1) / GRANULARITY;
+  Pool *pool = GetPool ();
+  if (size == 0 || c >= N_CLASSES || pool->count[c] >= MAX_FREE)
+    {
+      pool->stats.releases++;
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool->free[c];
+  pool->free[c] = block;
+  pool->count[c]++;
+}
+
+EventPool::Stats
+EventPool::GetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetPool ()->stats;
+}
+
+void
+EventPool::ResetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Pool *pool = GetPool ();
+  pool->stats.hits = 0;
+  pool->stats.misses = 0;
+  pool->stats.releases = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief Free list allocator of the small objects created for every event.
+ *
+ * EventImpl and TimerImpl take their memory from this pool, so that the
+ * objects built by MakeEvent and MakeTimerImpl are recycled instead of
+ * going through malloc and free for every scheduled event.
+ *
+ * Sizes are rounded up to a multiple of GRANULARITY and served from one
+ * free list per size class; larger blocks go straight to the global
+ * operator new. Each thread has its own free lists and counters, so the
+ * threads of the realtime and distributed simulators never contend. A
+ * block freed by another thread than the one which allocated it simply
+ * joins the free list of the freeing thread. At most MAX_FREE blocks
+ * are kept per size class.
+ */
+class EventPool
+{
+public:
+  /** Allocation counters of a thread. */
+  struct Stats
+  {
+    uint64_t hits;     /**< Allocations served from a free list. */
+    uint64_t misses;   /**< Allocations forwarded to operator new. */
+    uint64_t releases; /**< Blocks returned to operator delete. */
+  };
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in] size The size of the block, in bytes.
+   * \returns The block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Free a block.
+   *
+   * \param [in] p The block returned by Allocate.
+   * \param [in] size The size given to Allocate.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the counters of the calling thread.
+   *
+   * \returns The counters since the thread started or the last ResetStats.
+   */
+  static Stats GetStats (void);
+  /** Reset the counters of the calling thread. */
+  static void ResetStats (void);
+
+  /** Size classes are multiples of this size, in bytes. */
+  static const std::size_t GRANULARITY = 16;
+  /** Number of size classes: blocks up to 256 bytes are pooled. */
+  static const std::size_t N_CLASSES = 16;
+  /** Maximum number of free blocks kept per size class. */
+  static const uint32_t MAX_FREE = 65536;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_POOL_H */
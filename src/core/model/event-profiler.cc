@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "nstime.h"
+#include "log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+#include <time.h>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/** \returns The monotonic wall clock, in ns. */
+uint64_t
+WallClock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** Statistics of a handler, summed over the contexts. */
+struct Row
+{
+  std::string name;      /**< Handler name. */
+  uint64_t count;        /**< Number of events. */
+  uint64_t wall;         /**< Total wall clock time, in ns. */
+  uint64_t wallMax;      /**< Longest event, in ns. */
+  uint64_t residence;    /**< Total time steps in the event list. */
+  uint64_t residenceMax; /**< Longest time in the event list. */
+};
+
+/**
+ * Order rows by decreasing total time.
+ *
+ * \param [in] a The first row.
+ * \param [in] b The second row.
+ * \returns \c true if \p a comes first.
+ */
+bool
+MoreWall (const Row &a, const Row &b)
+{
+  return a.wall > b.wall;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_current (0),
+    m_start (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Scheduled (uint32_t uid, uint64_t now)
+{
+  m_scheduled[uid] = now;
+}
+
+void
+EventProfiler::Removed (uint32_t uid)
+{
+  m_scheduled.erase (uid);
+}
+
+void
+EventProfiler::Start (const EventImpl *event, uint32_t uid, uint64_t ts, uint32_t context)
+{
+  Key key (&typeid (*event), context);
+  std::map<Key, Stats>::iterator i = m_stats.find (key);
+  if (i == m_stats.end ())
+    {
+      Stats stats = { 0, 0, 0, 0, 0 };
+      i = m_stats.insert (std::make_pair (key, stats)).first;
+    }
+  m_current = &i->second;
+  m_current->count++;
+
+  std::map<uint32_t, uint64_t>::iterator scheduled = m_scheduled.find (uid);
+  if (scheduled != m_scheduled.end ())
+    {
+      uint64_t residence = ts - scheduled->second;
+      m_current->residence += residence;
+      m_current->residenceMax = std::max (m_current->residenceMax, residence);
+      m_scheduled.erase (scheduled);
+    }
+  m_start = WallClock ();
+}
+
+void
+EventProfiler::End (void)
+{
+  uint64_t wall = WallClock () - m_start;
+  m_current->wall += wall;
+  m_current->wallMax = std::max (m_current->wallMax, wall);
+}
+
+void
+EventProfiler::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  // Sum the contexts of each handler; types of several shared libraries
+  // may have the same name
+  std::map<std::string, Row> byName;
+  uint64_t count = 0;
+  uint64_t wall = 0;
+  for (std::map<Key, Stats>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      std::string name = GetName (*i->first.first);
+      Row &row = byName[name];
+      row.name = name;
+      row.count += i->second.count;
+      row.wall += i->second.wall;
+      row.wallMax = std::max (row.wallMax, i->second.wallMax);
+      row.residence += i->second.residence;
+      row.residenceMax = std::max (row.residenceMax, i->second.residenceMax);
+      count += i->second.count;
+      wall += i->second.wall;
+    }
+  std::vector<Row> rows;
+  for (std::map<std::string, Row>::const_iterator i = byName.begin (); i != byName.end (); ++i)
+    {
+      rows.push_back (i->second);
+    }
+  std::sort (rows.begin (), rows.end (), MoreWall);
+
+  os << "Event profile: " << count << " events, " << wall / 1e9 << " s in handlers" << std::endl
+     << std::setw (10) << "events" << std::setw (8) << "time %"
+     << std::setw (12) << "total ms" << std::setw (10) << "mean us" << std::setw (10) << "max us"
+     << std::setw (14) << "mean delay s" << std::setw (14) << "max delay s"
+     << "  handler" << std::endl;
+  for (std::vector<Row>::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      os << std::fixed
+         << std::setw (10) << i->count
+         << std::setw (8) << std::setprecision (1) << (wall == 0 ? 0 : 100.0 * i->wall / wall)
+         << std::setw (12) << std::setprecision (3) << i->wall / 1e6
+         << std::setw (10) << i->wall / 1e3 / i->count
+         << std::setw (10) << i->wallMax / 1e3
+         << std::setw (14) << std::setprecision (9) << TimeStep (i->residence).GetSeconds () / i->count
+         << std::setw (14) << TimeStep (i->residenceMax).GetSeconds ()
+         << "  " << i->name << std::endl;
+    }
+}
+
+void
+EventProfiler::PrintFolded (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<Key, Stats>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      os << GetName (*i->first.first) << ";";
+      if (i->first.second == Simulator::NO_CONTEXT)
+        {
+          os << "no context";
+        }
+      else
+        {
+          os << "context " << i->first.second;
+        }
+      os << " " << i->second.wall << std::endl;
+    }
+}
+
+std::string
+EventProfiler::GetName (const std::type_info &type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+
+  // The events of MakeEvent are local classes of a function, or function
+  // template, whose first argument is the function invoked
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start == std::string::npos || start + 9 >= name.size ())
+    {
+      return name;
+    }
+  start += 10;
+  int depth = 0;
+  for (std::string::size_type i = start; i < name.size (); i++)
+    {
+      char c = name[i];
+      if ((c == ',' || c == '>' || c == ')') && depth == 0)
+        {
+          return name.substr (start, i - start);
+        }
+      else if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')')
+        {
+          depth--;
+        }
+    }
+  return name;
+}
+
+} // namespace ns3
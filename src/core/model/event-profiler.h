@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Per handler statistics of the events run by a simulator.
+ *
+ * Events are attributed to their handler, identified by the type of their
+ * EventImpl: for the events built by MakeEvent, which are all the events
+ * scheduled through Simulator::Schedule, this is the signature of the
+ * function or method invoked, including its class.  For each handler and
+ * each context the profiler records the number of events, the total and
+ * maximum wall clock time spent in the handler, and the simulated time
+ * between the scheduling and the execution of the events.
+ *
+ * The simulator calls Scheduled, Removed, Start and End; Print writes the
+ * handlers sorted by total time and PrintFolded writes the input of
+ * flamegraph.pl, one stack per handler and context weighted in ns.
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Record the insertion of an event.
+   *
+   * \param [in] uid The event uid.
+   * \param [in] now The current simulation time step.
+   */
+  void Scheduled (uint32_t uid, uint64_t now);
+  /**
+   * Forget an event removed before running.
+   *
+   * \param [in] uid The event uid.
+   */
+  void Removed (uint32_t uid);
+  /**
+   * Start timing an event.
+   *
+   * \param [in] event The event about to be invoked.
+   * \param [in] uid The event uid.
+   * \param [in] ts The event time step.
+   * \param [in] context The event context.
+   */
+  void Start (const EventImpl *event, uint32_t uid, uint64_t ts, uint32_t context);
+  /** Stop timing the event given to the last Start. */
+  void End (void);
+
+  /**
+   * Write the handlers sorted by decreasing total wall clock time.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+  /**
+   * Write one folded stack per handler and context.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void PrintFolded (std::ostream &os) const;
+
+  /**
+   * Get a readable name for a handler.
+   *
+   * \param [in] type The type of an EventImpl.
+   * \returns The function signature for the events of MakeEvent, else
+   *   the demangled type name.
+   */
+  static std::string GetName (const std::type_info &type);
+
+private:
+  /** Statistics of a handler in a context. */
+  struct Stats
+  {
+    uint64_t count;        /**< Number of events. */
+    uint64_t wall;         /**< Total wall clock time, in ns. */
+    uint64_t wallMax;      /**< Longest event, in ns. */
+    uint64_t residence;    /**< Total time steps spent in the event list. */
+    uint64_t residenceMax; /**< Longest time in the event list, in time steps. */
+  };
+  /** Handler type and context. */
+  typedef std::pair<const std::type_info *, uint32_t> Key;
+
+  /** Statistics by handler and context. */
+  std::map<Key, Stats> m_stats;
+  /** Insertion time of the pending events, by uid. */
+  std::map<uint32_t, uint64_t> m_scheduled;
+  /** Statistics of the running event. */
+  Stats *m_current;
+  /** Wall clock time of the last Start, in ns. */
+  uint64_t m_start;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
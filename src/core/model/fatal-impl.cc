@@ -31,7 +31,8 @@
 /**
  * \file
  * \ingroup fatalimpl
- * \brief Implementation of RegisterStream(), UnregisterStream(), and FlushStreams(); see Implementation note!
+ * \brief Implementation of RegisterStream(), UnregisterStream(), RegisterFlushHook(),
+ * FlushRegisteredStreams() and FlushStreams(); see Implementation note!
  *
  * \note Implementation.
  *
@@ -92,6 +93,34 @@ std::list<std::ostream*> *GetStreamList (void)
   return *pstreams;
 }
 
+/**
+ * \ingroup fatalimpl
+ * \brief Get the functions called after flushing the streams.
+ *
+ * \returns The list of functions.
+ */
+std::list<void (*) (void)> *GetFlushHooks (void)
+{
+  static std::list<void (*) (void)> hooks;
+  return &hooks;
+}
+
+/**
+ * \ingroup fatalimpl
+ * \brief Call the functions registered with RegisterFlushHook().
+ */
+/** Set while FlushStreams runs. */
+bool g_flushingStreams = false;
+
+void CallFlushHooks (void)
+{
+  std::list<void (*) (void)> *hooks = GetFlushHooks ();
+  for (std::list<void (*) (void)>::const_iterator i = hooks->begin (); i != hooks->end (); ++i)
+    {
+      (*i)();
+    }
+}
+
 }  // anonymous namespace
 
 void
@@ -118,6 +147,29 @@ UnregisterStream (std::ostream* stream)
     }
 }
 
+void
+RegisterFlushHook (void (*hook) (void))
+{
+  NS_LOG_FUNCTION (hook);
+  GetFlushHooks ()->push_back (hook);
+}
+
+void
+FlushRegisteredStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::list<std::ostream*> **pl = PeekStreamList ();
+  if (*pl == 0)
+    {
+      return;
+    }
+  for (std::list<std::ostream*>::const_iterator i = (*pl)->begin (); i != (*pl)->end (); ++i)
+    {
+      (*i)->flush ();
+    }
+  CallFlushHooks ();
+}
+
 /**
  * \ingroup fatalimpl
  * Anonymous namespace for fatal streams signal hander.
@@ -147,9 +199,13 @@ void
 FlushStreams (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  g_flushingStreams = true;
+  LogFlush ();
+
   std::list<std::ostream*> **pl = PeekStreamList ();
   if (*pl == 0)
     {
+      g_flushingStreams = false;
       return;
     }
 
@@ -172,6 +228,9 @@ FlushStreams (void)
       s->flush ();
     }
 
+  /* Write what the streams handed to other buffers */
+  CallFlushHooks ();
+
   /* Restore default SIGSEGV handler (Not that it matters anyway) */
   hdl.sa_handler=SIG_DFL;
   sigaction (SIGSEGV, &hdl, 0);
@@ -186,6 +245,13 @@ FlushStreams (void)
 
   delete l;
   *pl = 0;
+  g_flushingStreams = false;
+}
+
+bool
+IsFlushingStreams (void)
+{
+  return g_flushingStreams;
 }
 
 } // namespace FatalImpl
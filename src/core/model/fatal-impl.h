@@ -26,7 +26,8 @@
 /**
  * \file
  * \ingroup fatalimpl
- * \brief Declaration of RegisterStream(), UnregisterStream(), and FlushStreams().
+ * \brief Declaration of RegisterStream(), UnregisterStream(), RegisterFlushHook(),
+ * FlushRegisteredStreams(), FlushStreams() and IsFlushingStreams().
  */
 
 /**
@@ -72,6 +73,32 @@ void RegisterStream (std::ostream* stream);
  */
 void UnregisterStream (std::ostream* stream);
 
+/**
+ * \ingroup fatalimpl
+ *
+ * \brief Register a function writing the output which the registered
+ * streams hand to another buffer when they are flushed.
+ *
+ * FlushRegisteredStreams() and FlushStreams() call the function after
+ * flushing the streams.  On a fatal error, other threads may never run
+ * again: the function must write from the calling thread, and give up
+ * rather than wait for a lock.
+ *
+ * \param [in] hook The function.
+ */
+void RegisterFlushHook (void (*hook) (void));
+
+/**
+ * \ingroup fatalimpl
+ *
+ * \brief Flush all currently registered streams, and keep them registered.
+ *
+ * Unlike FlushStreams(), this can be called while the program goes on,
+ * for example before duplicating the process so that the copies do not
+ * write the buffered output again.
+ */
+void FlushRegisteredStreams (void);
+
 /**
  * \ingroup fatalimpl
  *
@@ -88,10 +115,25 @@ void UnregisterStream (std::ostream* stream);
  * skip the bad \c ostream* and continue to flush the next stream.
  * The function will then terminate raising \c SIGIOT (aka \c SIGABRT)
  *
+ * While this function runs, IsFlushingStreams() returns \c true, so that
+ * the stream buffers and the flush hooks it calls only try to take their
+ * locks: the failing thread, or a thread which will never run again, may
+ * hold them.  The output behind a lock which stays held is lost.
+ *
  * DO NOT call this function until the program is ready to crash.
  */
 void FlushStreams (void);
 
+/**
+ * \ingroup fatalimpl
+ *
+ * \brief Check whether FlushStreams() is running.
+ *
+ * \returns \c true if the calling code runs on the fatal error path,
+ * and must not wait for a lock.
+ */
+bool IsFlushingStreams (void);
+
 } //FatalImpl
 } //ns3
 
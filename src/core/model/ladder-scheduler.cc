@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung)
+{
+  return rung.m_start + rung.m_current * rung.m_width;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::AddRung (uint64_t start, uint64_t end, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << start << end << n);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && start < end && n > 0);
+  Rung &rung = m_rungs[m_nRungs++];
+  uint64_t range = end - start;
+  rung.m_start = start;
+  rung.m_width = std::max<uint64_t> ((range + n - 1) / n, 1);
+  rung.m_current = 0;
+  rung.m_nBuckets = (range + rung.m_width - 1) / rung.m_width;
+  if (rung.m_buckets.size () < rung.m_nBuckets)
+    {
+      rung.m_buckets.resize (rung.m_nBuckets);
+    }
+  return rung;
+}
+
+void
+LadderScheduler::Spread (Bucket &events, Rung &rung)
+{
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint64_t index = (i->key.m_ts - rung.m_start) / rung.m_width;
+      NS_ASSERT (index >= rung.m_current && index < rung.m_nBuckets);
+      rung.m_buckets[index].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+      return;
+    }
+  for (uint32_t r = 0; r < m_nRungs; r++)
+    {
+      Rung &rung = m_rungs[r];
+      if (ts >= CurrentStart (rung))
+        {
+          rung.m_buckets[(ts - rung.m_start) / rung.m_width].push_back (ev);
+          return;
+        }
+    }
+  InsertBottom (ev);
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev), ev);
+  if (m_bottom.size () > BUCKET_THRESHOLD
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      SplitBottom ();
+    }
+}
+
+void
+LadderScheduler::SplitBottom (void)
+{
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  if (m_nRungs == 0)
+    {
+      // Top starts above the events of Bottom: lower it and let the next
+      // Refill build a rung spanning both.
+      if (m_top.empty ())
+        {
+          m_topMax = m_bottom.back ().key.m_ts;
+        }
+      m_topMin = m_bottom.front ().key.m_ts;
+      m_topStart = m_topMin;
+      m_top.insert (m_top.end (), m_bottom.begin (), m_bottom.end ());
+      m_bottom.clear ();
+      return;
+    }
+  if (m_nRungs == MAX_RUNGS)
+    {
+      return;
+    }
+  uint64_t end = CurrentStart (m_rungs[m_nRungs - 1]);
+  Rung &rung = AddRung (m_bottom.front ().key.m_ts, end, m_bottom.size ());
+  for (std::deque<Event>::const_iterator i = m_bottom.begin (); i != m_bottom.end (); ++i)
+    {
+      rung.m_buckets[(i->key.m_ts - rung.m_start) / rung.m_width].push_back (*i);
+    }
+  m_bottom.clear ();
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty () && m_size > 0);
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          if (m_top.size () <= BUCKET_THRESHOLD || m_topMin == m_topMax)
+            {
+              std::sort (m_top.begin (), m_top.end ());
+              m_bottom.assign (m_top.begin (), m_top.end ());
+              m_topStart = m_top.back ().key.m_ts + 1;
+              m_top.clear ();
+              return;
+            }
+          Rung &rung = AddRung (m_topMin, m_topMax + 1, m_top.size ());
+          m_topStart = rung.m_start + rung.m_nBuckets * rung.m_width;
+          Spread (m_top, rung);
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.m_current < rung.m_nBuckets && rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      if (rung.m_current == rung.m_nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      uint64_t end = CurrentStart (rung) + rung.m_width;
+      rung.m_current++;
+      if (bucket.size () > BUCKET_THRESHOLD && rung.m_width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t start = bucket.front ().key.m_ts;
+          uint64_t last = start;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              start = std::min (start, i->key.m_ts);
+              last = std::max (last, i->key.m_ts);
+            }
+          // Events sharing a single timestamp can only be sorted by uid.
+          if (start != last)
+            {
+              Spread (bucket, AddRung (start, end, bucket.size ()));
+              continue;
+            }
+        }
+      std::sort (bucket.begin (), bucket.end ());
+      m_bottom.assign (bucket.begin (), bucket.end ());
+      bucket.clear ();
+      return;
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      // Moving events between tiers does not change the event set.
+      const_cast<LadderScheduler *> (this)->Refill ();
+    }
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  Scheduler::Event ev = m_bottom.front ();
+  m_bottom.pop_front ();
+  m_size--;
+  NS_LOG_DEBUG ("remove " << ev.impl << " at " << ev.key.m_ts);
+  return ev;
+}
+
+void
+LadderScheduler::RemoveFrom (Bucket &bucket, const Event &ev)
+{
+  for (Bucket::iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          *i = bucket.back ();
+          bucket.pop_back ();
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  m_size--;
+  // Events are found where Insert would put them now.
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      RemoveFrom (m_top, ev);
+      return;
+    }
+  for (uint32_t r = 0; r < m_nRungs; r++)
+    {
+      Rung &rung = m_rungs[r];
+      if (ts >= CurrentStart (rung))
+        {
+          RemoveFrom (rung.m_buckets[(ts - rung.m_start) / rung.m_width], ev);
+          return;
+        }
+    }
+  std::deque<Event>::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+  m_bottom.erase (i);
+}
+
+} // namespace ns3
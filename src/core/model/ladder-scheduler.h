@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <deque>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the Ladder Queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005). Events are kept in three tiers:
+ *
+ *  - Top: an unsorted vector of the events far in the future, whose
+ *    timestamps are all larger than or equal to the start of Top;
+ *  - the Ladder: up to MAX_RUNGS rungs of unsorted buckets. The first
+ *    rung is built from Top, and every further rung subdivides the
+ *    bucket of the previous rung which held too many events to be sorted;
+ *  - Bottom: a sorted deque of the earliest events, refilled from the
+ *    first non empty bucket of the last rung.
+ *
+ * Unlike the calendar queue, the bucket width is derived from the events
+ * actually transferred to each rung, so there is no resizing heuristic to
+ * get wrong when the timestamp distribution is skewed: a burst of close
+ * events simply spawns a finer rung. Only Bottom, which is kept below
+ * BUCKET_THRESHOLD events whenever their timestamps allow it, is ever
+ * sorted. Buckets are vectors which keep their storage across rungs.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket type: an unsorted vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t m_start;              /**< Timestamp of the start of the first bucket. */
+    uint64_t m_width;              /**< Duration of a bucket, in dimensionless time units. */
+    uint32_t m_current;            /**< Index of the first bucket not transferred yet. */
+    uint32_t m_nBuckets;           /**< Number of buckets in use. */
+    std::vector<Bucket> m_buckets; /**< Buckets, possibly more than m_nBuckets. */
+  };
+
+  /** Number of events above which a bucket is split instead of sorted. */
+  static const uint32_t BUCKET_THRESHOLD = 50;
+  /** Maximum number of rungs of the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /**
+   * Get the timestamp of the start of the current bucket of a rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The smallest timestamp the rung may hold.
+   */
+  static inline uint64_t CurrentStart (const Rung &rung);
+  /**
+   * Append a rung covering a range of timestamps.
+   *
+   * \param [in] start The smallest timestamp of the range.
+   * \param [in] end The timestamp just after the range.
+   * \param [in] n The number of events about to be transferred.
+   * \returns The new rung.
+   */
+  Rung & AddRung (uint64_t start, uint64_t end, uint32_t n);
+  /**
+   * Transfer events to a rung.
+   *
+   * \param [in,out] events The events, cleared on return.
+   * \param [in,out] rung The rung covering all the events.
+   */
+  static void Spread (Bucket &events, Rung &rung);
+  /**
+   * Insert an event in Bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Move the events of an oversized Bottom back to the ladder or Top. */
+  void SplitBottom (void);
+  /** Transfer the earliest events to an empty Bottom. */
+  void Refill (void);
+  /**
+   * Remove an event from an unsorted bucket.
+   *
+   * \param [in,out] bucket The bucket holding the event.
+   * \param [in] ev The event.
+   */
+  static void RemoveFrom (Bucket &bucket, const Scheduler::Event &ev);
+
+  /** Unsorted events beyond the ladder. */
+  Bucket m_top;
+  /** Smallest timestamp which belongs to Top. */
+  uint64_t m_topStart;
+  /** Lower bound of the timestamps in Top. */
+  uint64_t m_topMin;
+  /** Upper bound of the timestamps in Top. */
+  uint64_t m_topMax;
+  /** The rungs, of which the first m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Sorted earliest events. */
+  std::deque<Scheduler::Event> m_bottom;
+  /** Number of events in the scheduler. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
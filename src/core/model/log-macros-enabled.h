@@ -27,6 +27,17 @@
  * Definition of logging macros.
  */
 
+#if (__GNUC__ >= 3)
+/**
+ * \ingroup logging
+ * Tell the compiler that a logging condition is usually false.
+ * \param [in] condition The condition.
+ */
+#define NS_LOG_UNLIKELY(condition) __builtin_expect (!!(condition), 0)
+#else
+#define NS_LOG_UNLIKELY(condition) (condition)
+#endif
+
 #ifdef NS3_LOG_ENABLE
 
 
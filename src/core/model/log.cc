@@ -22,9 +22,17 @@
 #include <list>
 #include <utility>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <streambuf>
 #include "assert.h"
 #include "ns3/core-config.h"
 #include "fatal-error.h"
+#include "fatal-impl.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #ifdef HAVE_GETENV
 #include <cstring>
@@ -55,6 +63,8 @@ static LogTimePrinter g_logTimePrinter = 0;
  */
 static LogNodePrinter g_logNodePrinter = 0;
 
+bool LogComponent::g_anyEnabled = false;
+
 /**
  * \ingroup logging
  * Handler for \c print-list token in NS_LOG
@@ -268,13 +278,6 @@ LogComponent::EnvVarCheck (void)
 }
 
 
-bool 
-LogComponent::IsEnabled (const enum LogLevel level) const
-{
-  //  LogComponentEnableEnvVar ();
-  return (level & m_levels) ? 1 : 0;
-}
-
 bool
 LogComponent::IsNoneEnabled (void) const
 {
@@ -291,12 +294,38 @@ void
 LogComponent::Enable (const enum LogLevel level)
 {
   m_levels |= (level & ~m_mask);
+  if (m_levels != 0)
+    {
+      g_anyEnabled = true;
+    }
 }
 
 void 
 LogComponent::Disable (const enum LogLevel level)
 {
   m_levels &= ~level;
+  if (m_levels == 0)
+    {
+      UpdateAnyEnabled ();
+    }
+}
+
+/* static */
+void
+LogComponent::UpdateAnyEnabled (void)
+{
+  LogComponent::ComponentList *components = GetComponentList ();
+  for (LogComponent::ComponentList::const_iterator i = components->begin ();
+       i != components->end ();
+       i++)
+    {
+      if (!i->second->IsNoneEnabled ())
+        {
+          g_anyEnabled = true;
+          return;
+        }
+    }
+  g_anyEnabled = false;
 }
 
 char const *
@@ -631,6 +660,334 @@ LogNodePrinter LogGetNodePrinter (void)
   return g_logNodePrinter;
 }
 
+/**
+ * \ingroup logging
+ * Stream buffer installed in \c std::clog by LogSetBufferSize.
+ *
+ * Each thread appends to its own buffer, found through a thread specific
+ * key, and writes it to the previous stream buffer of \c std::clog, under
+ * a lock, once it holds a complete message and at least the buffer size.
+ * Each buffer has its own lock, only contended when FlushAll writes the
+ * buffers of the other threads.  On the fatal error path, the locks are
+ * only tried, and the output behind a held lock is dropped.
+ * This is private to the logging implementation.
+ */
+class LogSink : public std::streambuf
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] next The stream buffer receiving the output.
+   * \param [in] size The size of the buffer of each thread.
+   */
+  LogSink (std::streambuf *next, uint32_t size);
+  /** Destructor, writes and frees the buffers of all threads. */
+  virtual ~LogSink ();
+  /** \returns The stream buffer receiving the output. */
+  std::streambuf *GetNext (void) const;
+  /** Write the buffers of all threads. */
+  void FlushAll (void);
+
+protected:
+  virtual int overflow (int c);
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int sync (void);
+
+private:
+  /** The buffer of a thread. */
+  struct Buffer
+  {
+    LogSink *sink;     //!< The LogSink owning this buffer.
+    std::string data;  //!< The pending output.
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_t mutex;  //!< Protects data against FlushAll.
+#endif
+  };
+  /** \returns The buffer of the calling thread. */
+  Buffer *GetBuffer (void);
+  /**
+   * Write and empty a buffer.
+   * \param [in,out] buffer The buffer.
+   */
+  void Write (Buffer *buffer);
+#ifdef HAVE_PTHREAD_H
+  /**
+   * Write and free the buffer of an exiting thread.
+   * \param [in] buffer The buffer.
+   */
+  static void ThreadExit (void *buffer);
+  /**
+   * Take a lock, or only try to while FatalImpl::FlushStreams runs: the
+   * failing thread, or a thread which will never run again, may hold it.
+   * \param [in] mutex The lock.
+   * \returns Whether the lock was taken.
+   */
+  static bool Lock (pthread_mutex_t *mutex);
+
+  pthread_key_t m_key;             //!< The buffer of each thread.
+  pthread_mutex_t m_mutex;         //!< Protects m_buffers and m_next, taken before the lock of a buffer.
+#endif /* HAVE_PTHREAD_H */
+  std::list<Buffer *> m_buffers;   //!< The buffers of all threads.
+  std::streambuf *m_next;          //!< The stream buffer receiving the output.
+  uint32_t m_size;                 //!< The size of the buffers.
+};
+
+LogSink::LogSink (std::streambuf *next, uint32_t size)
+  : m_next (next),
+    m_size (size)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_key_create (&m_key, &LogSink::ThreadExit);
+  pthread_mutex_init (&m_mutex, NULL);
+#endif
+}
+
+LogSink::~LogSink ()
+{
+  FlushAll ();
+#ifdef HAVE_PTHREAD_H
+  pthread_key_delete (m_key);
+  pthread_mutex_destroy (&m_mutex);
+#endif
+  for (std::list<Buffer *>::iterator i = m_buffers.begin (); i != m_buffers.end (); ++i)
+    {
+#ifdef HAVE_PTHREAD_H
+      pthread_mutex_destroy (&(*i)->mutex);
+#endif
+      delete *i;
+    }
+}
+
+std::streambuf *
+LogSink::GetNext (void) const
+{
+  return m_next;
+}
+
+LogSink::Buffer *
+LogSink::GetBuffer (void)
+{
+#ifdef HAVE_PTHREAD_H
+  Buffer *buffer = static_cast<Buffer *> (pthread_getspecific (m_key));
+  if (buffer == 0)
+    {
+      buffer = new Buffer;
+      buffer->sink = this;
+      buffer->data.reserve (m_size);
+      pthread_mutex_init (&buffer->mutex, NULL);
+      pthread_setspecific (m_key, buffer);
+      if (Lock (&m_mutex))
+        {
+          m_buffers.push_back (buffer);
+          pthread_mutex_unlock (&m_mutex);
+        }
+    }
+  return buffer;
+#else
+  if (m_buffers.empty ())
+    {
+      Buffer *buffer = new Buffer;
+      buffer->sink = this;
+      buffer->data.reserve (m_size);
+      m_buffers.push_back (buffer);
+    }
+  return m_buffers.front ();
+#endif
+}
+
+void
+LogSink::Write (Buffer *buffer)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!Lock (&m_mutex))
+    {
+      return;
+    }
+  if (!Lock (&buffer->mutex))
+    {
+      pthread_mutex_unlock (&m_mutex);
+      return;
+    }
+#endif
+  if (!buffer->data.empty ())
+    {
+      m_next->sputn (buffer->data.data (), buffer->data.size ());
+      m_next->pubsync ();
+      buffer->data.clear ();
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&buffer->mutex);
+  pthread_mutex_unlock (&m_mutex);
+#endif
+}
+
+void
+LogSink::FlushAll (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!Lock (&m_mutex))
+    {
+      return;
+    }
+#endif
+  for (std::list<Buffer *>::iterator i = m_buffers.begin (); i != m_buffers.end (); ++i)
+    {
+#ifdef HAVE_PTHREAD_H
+      // The owner thread may be appending
+      if (!Lock (&(*i)->mutex))
+        {
+          continue;
+        }
+#endif
+      m_next->sputn ((*i)->data.data (), (*i)->data.size ());
+      (*i)->data.clear ();
+#ifdef HAVE_PTHREAD_H
+      pthread_mutex_unlock (&(*i)->mutex);
+#endif
+    }
+  m_next->pubsync ();
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&m_mutex);
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+/* static */
+void
+LogSink::ThreadExit (void *buffer)
+{
+  Buffer *b = static_cast<Buffer *> (buffer);
+  LogSink *sink = b->sink;
+  sink->Write (b);
+  pthread_mutex_lock (&sink->m_mutex);
+  sink->m_buffers.remove (b);
+  pthread_mutex_unlock (&sink->m_mutex);
+  pthread_mutex_destroy (&b->mutex);
+  delete b;
+}
+
+/* static */
+bool
+LogSink::Lock (pthread_mutex_t *mutex)
+{
+  if (FatalImpl::IsFlushingStreams ())
+    {
+      return pthread_mutex_trylock (mutex) == 0;
+    }
+  pthread_mutex_lock (mutex);
+  return true;
+}
+#endif /* HAVE_PTHREAD_H */
+
+int
+LogSink::overflow (int c)
+{
+  if (c != EOF)
+    {
+      Buffer *buffer = GetBuffer ();
+#ifdef HAVE_PTHREAD_H
+      if (!Lock (&buffer->mutex))
+        {
+          return c;
+        }
+#endif
+      buffer->data.push_back (static_cast<char> (c));
+#ifdef HAVE_PTHREAD_H
+      pthread_mutex_unlock (&buffer->mutex);
+#endif
+    }
+  return c;
+}
+
+std::streamsize
+LogSink::xsputn (const char *s, std::streamsize n)
+{
+  Buffer *buffer = GetBuffer ();
+#ifdef HAVE_PTHREAD_H
+  if (!Lock (&buffer->mutex))
+    {
+      return n;
+    }
+#endif
+  buffer->data.append (s, n);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&buffer->mutex);
+#endif
+  return n;
+}
+
+int
+LogSink::sync (void)
+{
+  // Called by std::endl at the end of each message
+  Buffer *buffer = GetBuffer ();
+#ifdef HAVE_PTHREAD_H
+  if (!Lock (&buffer->mutex))
+    {
+      return 0;
+    }
+#endif
+  bool full = buffer->data.size () >= m_size;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&buffer->mutex);
+#endif
+  if (full)
+    {
+      Write (buffer);
+    }
+  return 0;
+}
+
+/**
+ * \ingroup logging
+ * The LogSink installed in std::clog, if any.
+ * This is private to the logging implementation.
+ */
+static LogSink *g_logSink = 0;
+
+/**
+ * \ingroup logging
+ * Write the buffered output and restore std::clog at exit.
+ * This is private to the logging implementation.
+ */
+static void
+LogSinkAtExit (void)
+{
+  LogSetBufferSize (0);
+}
+
+void
+LogSetBufferSize (uint32_t size)
+{
+  static bool atExit = false;
+  if (g_logSink != 0)
+    {
+      std::clog.rdbuf (g_logSink->GetNext ());
+      delete g_logSink;
+      g_logSink = 0;
+    }
+  if (size > 0)
+    {
+      if (!atExit)
+        {
+          std::atexit (&LogSinkAtExit);
+          atExit = true;
+        }
+      g_logSink = new LogSink (std::clog.rdbuf (), size);
+      std::clog.rdbuf (g_logSink);
+    }
+}
+
+void
+LogFlush (void)
+{
+  if (g_logSink != 0)
+    {
+      g_logSink->FlushAll ();
+    }
+}
+
 
 ParameterLogger::ParameterLogger (std::ostream &os)
   : m_first (true),
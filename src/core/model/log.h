@@ -199,7 +199,7 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] name The log component name.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__)
+  NS_LOG_COMPONENT_DEFINE_CEILING (name, NS3_LOG_CEILING)
 
 /**
  * Define a logging component with a mask.
@@ -210,7 +210,35 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] mask The default mask.
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
+  static ns3::LogComponentWithCeiling<NS3_LOG_CEILING> g_log (name, __FILE__, mask)
+
+/**
+ * Define a logging component whose levels above \p ceiling are
+ * removed at compile time.
+ *
+ * The logging statements of the levels not in \p ceiling are constant
+ * false conditions, which the compiler removes with their arguments,
+ * and these levels cannot be enabled.  For example
+ * \code
+ *   NS_LOG_COMPONENT_DEFINE_CEILING ("AodvRoutingProtocol", ns3::LOG_LEVEL_WARN);
+ * \endcode
+ * keeps only the errors and warnings of this component.
+ *
+ * \param [in] name The log component name.
+ * \param [in] ceiling The levels compiled in, such as ns3::LOG_LEVEL_INFO,
+ *   or ns3::LOG_NONE to remove all logging.
+ */
+#define NS_LOG_COMPONENT_DEFINE_CEILING(name, ceiling)          \
+  static ns3::LogComponentWithCeiling<ceiling> g_log (name, __FILE__)
+
+#ifndef NS3_LOG_CEILING
+/**
+ * The levels compiled in by NS_LOG_COMPONENT_DEFINE: all of them, unless
+ * the build defines another ceiling, for example with
+ * \c -DNS3_LOG_CEILING=ns3::LOG_LEVEL_WARN in \c CXXFLAGS.
+ */
+#define NS3_LOG_CEILING ns3::LOG_ALL
+#endif
 
 /**
  * Use \ref NS_LOG to output a message of level LOG_ERROR.
@@ -328,7 +356,11 @@ public:
    * \param [in] level The level to check for.
    * \return \c true if we are enabled at \c level.
    */
-  bool IsEnabled (const enum LogLevel level) const;
+  inline bool IsEnabled (const enum LogLevel level) const
+  {
+    // Test the global flag first: it stays in cache, m_levels may not
+    return NS_LOG_UNLIKELY (g_anyEnabled) && (level & m_levels) != 0;
+  }
   /**
    * Check if all levels are disabled.
    *
@@ -401,6 +433,14 @@ private:
    * LogComponent.
    */
   void EnvVarCheck (void);
+  /** Update g_anyEnabled after disabling some levels. */
+  static void UpdateAnyEnabled (void);
+
+  /**
+   * \c true if some LogComponent has some LogLevel enabled, so that the
+   * disabled logging statements cost a single well predicted branch.
+   */
+  static bool g_anyEnabled;
   
   int32_t     m_levels;  //!< Enabled LogLevels.
   int32_t     m_mask;    //!< Blocked LogLevels.
@@ -409,6 +449,61 @@ private:
 
 };  // class LogComponent
 
+/**
+ * A LogComponent whose levels outside of \p ceiling are disabled at
+ * compile time.  Defined by NS_LOG_COMPONENT_DEFINE_CEILING.
+ *
+ * \tparam ceiling The LogLevels which can be enabled.
+ */
+template <uint32_t ceiling>
+class LogComponentWithCeiling : public LogComponent
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] name The user-visible name for this component.
+   * \param [in] file The source code file which defined this LogComponent.
+   * \param [in] mask LogLevels blocked for this LogComponent, in addition
+   *                  to those outside of the ceiling.
+   */
+  LogComponentWithCeiling (const std::string & name,
+                           const std::string & file,
+                           const enum LogLevel mask = LOG_NONE)
+    : LogComponent (name, file, (enum LogLevel)(mask | (LOG_ALL & ~ceiling)))
+  {
+  }
+  /**
+   * Check if this LogComponent is enabled for \c level: a constant
+   * \c false for the levels outside of the ceiling.
+   *
+   * \param [in] level The level to check for.
+   * \return \c true if we are enabled at \c level.
+   */
+  inline bool IsEnabled (const enum LogLevel level) const
+  {
+    return (level & (ceiling | LOG_PREFIX_ALL)) != 0 && LogComponent::IsEnabled (level);
+  }
+};
+
+/**
+ * Buffer the logging output written to \c std::clog.
+ *
+ * Each thread appends its messages to its own buffer, under a lock only
+ * contended by LogFlush, and writes the buffer to the previous output of
+ * \c std::clog when it holds \p size bytes, at exit, on a fatal error and
+ * on LogFlush, which writes the buffers of all threads.  The
+ * messages of different threads are therefore no longer interleaved in
+ * time order.
+ *
+ * \param [in] size The size of the buffer of each thread, in bytes, or 0
+ *   to write each message directly, the default.
+ */
+void LogSetBufferSize (uint32_t size);
+
+/** Write the logging output buffered by all threads. */
+void LogFlush (void);
+
   
 /**
  * Insert `, ` when streaming function arguments.
@@ -92,6 +92,13 @@ class TimeWithUnit;
  * data structure and stop tracking new instances, so we have no way
  * to do a second conversion.)
  *
+ * Configuring with \c --fixed-time-resolution=unit, for example \c us,
+ * removes this tracking.  This defines \c NS3_FIXED_TIME_RESOLUTION to the
+ * bare Time::Unit enumerator, here \c US; the resolution is then fixed to
+ * that unit at build time, SetResolution()
+ * only accepts it, and Time is a trivially copyable 64-bit integer which
+ * costs no more than an \c int64_t to create, copy and destroy.
+ *
  * If you increase the global resolution, you also implicitly decrease
  * the range of your simulation.  The global simulation time is stored
  * in a 64 bit integer, whose interpretation will depend on the global
@@ -120,6 +127,7 @@ public:
     LAST = 10
   };
 
+#ifndef NS3_FIXED_TIME_RESOLUTION
   /**
    *  Assignment operator
    * \param [in] o Time to assign.
@@ -130,15 +138,14 @@ public:
     m_data = o.m_data;
     return *this;
   }
+#endif /* NS3_FIXED_TIME_RESOLUTION */
   /** Default constructor, with value 0. */
   inline Time ()
     : m_data ()
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
+#ifndef NS3_FIXED_TIME_RESOLUTION
   /**
    *  Copy constructor
    *
@@ -147,11 +154,9 @@ public:
   inline Time(const Time & o)
     : m_data (o.m_data)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
+#endif /* NS3_FIXED_TIME_RESOLUTION */
   /**
    * \name Numeric constructors.
    *  Construct from a numeric value.
@@ -165,66 +170,42 @@ public:
   explicit inline Time (double v)
     : m_data (lround (v))
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (long int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (long long int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (unsigned int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (unsigned long int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (unsigned long long int v)
     : m_data (v)
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   explicit inline Time (const int64x64_t & v)
     : m_data (v.GetHigh ())
   {
-    if (g_markingTimes)
-      {
-	Mark (this);
-      }
+    MarkIfNeeded ();
   }
   /**@}*/
   
@@ -261,6 +242,7 @@ public:
     return Time (std::numeric_limits<int64_t>::max ());
   }
 
+#ifndef NS3_FIXED_TIME_RESOLUTION
   /** Destructor */
   ~Time ()
   {
@@ -269,6 +251,7 @@ public:
         Clear (this);
       }
   }
+#endif /* NS3_FIXED_TIME_RESOLUTION */
 
   /** \return \c true if the time is zero, \c false otherwise. */
   inline bool IsZero (void) const
@@ -394,7 +377,8 @@ public:
    *
    * Change the global resolution used to convert all
    * user-provided time values in Time objects and Time objects
-   * in user-expected time units.
+   * in user-expected time units.  With a fixed resolution this
+   * is a fatal error unless \p resolution is the fixed unit.
    */
   static void SetResolution (enum Unit resolution);
   /**
@@ -655,6 +639,16 @@ private:
    *  \param [in] unit The Unit to convert existing Times to.
    */
   static void ConvertTimes (const enum Unit unit);
+  /** Record this instance with the MarkedTimes, if they are still kept. */
+  inline void MarkIfNeeded (void)
+  {
+#ifndef NS3_FIXED_TIME_RESOLUTION
+    if (g_markingTimes)
+      {
+        Mark (this);
+      }
+#endif /* NS3_FIXED_TIME_RESOLUTION */
+  }
 
   /*
    * \name Arithmetic Operators
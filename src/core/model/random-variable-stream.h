@@ -149,6 +149,19 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * The values are the same as those of \p n calls to GetValue(void),
+   * and the stream is left in the same state, but the distributions
+   * which override this method draw their uniform variates in bulk, once
+   * per call rather than once per value.
+   *
+   * \param [out] values The array receiving the random values.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
@@ -293,6 +306,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -352,6 +366,7 @@ public:
   virtual double GetValue (void);
   /* \note This RNG always returns the same value. */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The constant value returned by this RNG stream. */
@@ -585,6 +600,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -33,6 +33,7 @@
 #include "enum.h"
 
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -107,6 +108,7 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -208,6 +210,15 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
       { 
         CriticalSection cs (m_mutex);
+        //
+        // This next line resets the synchronizer so that any future event will
+        // cause it to interrupt.  It comes before we pick up the events injected
+        // by other threads: an event injected after that point signals the
+        // synchronizer and interrupts the wait below.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
+
         //
         // Since we are in realtime mode, the time to delay has got to be the 
         // difference between the current realtime and the timestamp of the next 
@@ -251,12 +262,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
         //
         // We've figured out how long we need to delay in order to pace the 
-        // simulation time with the real time.  We're going to sleep, but need
-        // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
+        // simulation time with the real time.  We're going to sleep, but the
+        // synchronizer was reset above so we're awakened if something 
+        // external happens (like a packet is received).
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -405,6 +414,62 @@ RealtimeSimulatorImpl::IsFinished (void) const
   return rc;
 }
 
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.IsEmpty ())
+    {
+      return;
+    }
+
+  m_eventsWithContext.Drain (m_injected);
+  for (std::vector<EventInjectionQueue::Entry>::const_iterator i = m_injected.begin ();
+       i != m_injected.end (); ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = i->event;
+      //
+      // The timestamp was taken from the realtime clock when the event was
+      // injected.  The main thread may have run a later event since, in
+      // which case the injected event runs now.
+      //
+      ev.key.m_ts = std::max (i->ts, m_currentTs);
+      ev.key.m_context = i->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+  m_injected.clear ();
+}
+
+void
+RealtimeSimulatorImpl::InsertWithContext (uint32_t context, uint64_t ts, EventImpl *impl)
+{
+  if (!SystemThread::Equals (m_main))
+    {
+      EventInjectionQueue::Entry entry;
+      entry.event = impl;
+      entry.ts = ts;
+      entry.context = context;
+      m_eventsWithContext.Push (entry);
+      m_synchronizer->Signal ();
+      return;
+    }
+
+  CriticalSection cs (m_mutex);
+  NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::InsertWithContext(): schedule for time < m_currentTs");
+  Scheduler::Event ev;
+  ev.impl = impl;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+  m_synchronizer->Signal ();
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
@@ -442,6 +507,9 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        // Reset before draining, see ProcessOneEvent
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -543,35 +611,21 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
-  {
-    CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
-
-    NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
-    Scheduler::Event ev;
-    ev.impl = impl;
-    ev.key.m_ts = ts;
-    ev.key.m_context = context;
-    ev.key.m_uid = m_uid;
-    m_uid++;
-    m_unscheduledEvents++;
-    m_events->Insert (ev);
-    m_synchronizer->Signal ();
-  }
+  uint64_t ts;
+  if (SystemThread::Equals (m_main))
+    {
+      ts = m_currentTs + delay.GetTimeStep ();
+    }
+  else
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // 
+      ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+      ts += delay.GetTimeStep ();
+    }
+  InsertWithContext (context, ts, impl);
 }
 
 EventId
@@ -609,20 +663,8 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
-  {
-    CriticalSection cs (m_mutex);
-
-    uint64_t ts = m_synchronizer->GetCurrentRealtime () + time.GetTimeStep ();
-    NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
-    Scheduler::Event ev;
-    ev.impl = impl;
-    ev.key.m_ts = ts;
-    ev.key.m_uid = m_uid;
-    m_uid++;
-    m_unscheduledEvents++;
-    m_events->Insert (ev);
-    m_synchronizer->Signal ();
-  }
+  uint64_t ts = m_synchronizer->GetCurrentRealtime () + time.GetTimeStep ();
+  InsertWithContext (context, ts, impl);
 }
 
 void
@@ -636,26 +678,13 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
-  {
-    CriticalSection cs (m_mutex);
 
-    //
-    // If the simulator is running, we're pacing and have a meaningful 
-    // realtime clock.  If we're not, then m_currentTs is were we stopped.
-    // 
-    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-    NS_ASSERT_MSG (ts >= m_currentTs, 
-                   "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time < m_currentTs");
-    Scheduler::Event ev;
-    ev.impl = impl;
-    ev.key.m_ts = ts;
-    ev.key.m_uid = m_uid;
-    ev.key.m_context = context;
-    m_uid++;
-    m_unscheduledEvents++;
-    m_events->Insert (ev);
-    m_synchronizer->Signal ();
-  }
+  //
+  // If the simulator is running, we're pacing and have a meaningful 
+  // realtime clock.  If we're not, then m_currentTs is were we stopped.
+  // 
+  uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+  InsertWithContext (context, ts, impl);
 }
 
 void
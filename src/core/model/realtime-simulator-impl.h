@@ -25,6 +25,7 @@
 #include "scheduler.h"
 #include "synchronizer.h"
 #include "event-impl.h"
+#include "event-injection-queue.h"
 
 #include "ptr.h"
 #include "assert.h"
@@ -32,6 +33,7 @@
 #include "system-mutex.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -172,6 +174,20 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move the events scheduled by other threads into the event list.
+   * Must be called by the main thread with #m_mutex held.
+   */
+  void ProcessEventsWithContext (void);
+  /**
+   * Insert an event in the event list, or in #m_eventsWithContext when
+   * called by another thread than the main thread.
+   *
+   * \param [in] context The event context.
+   * \param [in] ts The absolute timestamp of the event.
+   * \param [in] impl The event implementation.
+   */
+  void InsertWithContext (uint32_t context, uint64_t ts, EventImpl *impl);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -207,6 +223,14 @@ private:
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
+  /**
+   * Events scheduled with context by other threads, inserted by the main
+   * thread without taking #m_mutex on the producer side.
+   */
+  EventInjectionQueue m_eventsWithContext;
+  /** Events drained from m_eventsWithContext, kept to reuse its storage. */
+  std::vector<EventInjectionQueue::Entry> m_injected;
+
   /** The synchronizer in use to track real time. */
   Ptr<Synchronizer> m_synchronizer;
 
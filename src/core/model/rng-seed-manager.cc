@@ -100,9 +100,8 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint64_t next = g_nextStreamIndex;
-  g_nextStreamIndex++;
-  return next;
+  // Random variables may be created by several threads
+  return __sync_fetch_and_add (&g_nextStreamIndex, 1);
 }
 
 } // namespace ns3
@@ -70,6 +70,14 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream, the same as
+   * \p n calls to RandU01 but with the state kept in registers.
+   *
+   * \param [out] values The array receiving the random numbers.
+   * \param [in] n The number of random numbers to generate.
+   */
+  void RandU01 (double *values, uint32_t n);
 
 private:
   /**
@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SmallVector declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief A contiguous array which stores up to N elements in the object.
+ *
+ * The first N elements need no allocation: a larger array is allocated
+ * only when the N+1th element is added, and the elements stay contiguous.
+ * The elements are default constructed in the unused slots, so \p T must
+ * be cheap to default construct and to assign, like a Callback or a Ptr.
+ *
+ * Only the operations needed by TracedCallback are provided.
+ *
+ * \tparam T \explicit The type of the elements.
+ * \tparam N \explicit The number of elements stored in the object, at least 1.
+ */
+template <typename T, uint32_t N>
+class SmallVector
+{
+public:
+  /** Iterator over the elements. */
+  typedef T *iterator;
+  /** Constant iterator over the elements. */
+  typedef const T *const_iterator;
+
+  /** Create an empty array. */
+  SmallVector ();
+  /**
+   * Copy constructor.
+   * \param [in] o The array to copy.
+   */
+  SmallVector (const SmallVector &o);
+  /**
+   * Assignment operator.
+   * \param [in] o The array to copy.
+   * \returns This array.
+   */
+  SmallVector & operator = (const SmallVector &o);
+  /** Destructor. */
+  ~SmallVector ();
+
+  /** \returns \c true if there is no element. */
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+  /** \returns The number of elements. */
+  uint32_t size (void) const
+  {
+    return m_size;
+  }
+  /** \returns An iterator to the first element. */
+  iterator begin (void)
+  {
+    return m_data;
+  }
+  /** \returns An iterator past the last element. */
+  iterator end (void)
+  {
+    return m_data + m_size;
+  }
+  /** \copydoc begin() */
+  const_iterator begin (void) const
+  {
+    return m_data;
+  }
+  /** \copydoc end() */
+  const_iterator end (void) const
+  {
+    return m_data + m_size;
+  }
+  /**
+   * \param [in] i The index of an element.
+   * \returns The element.
+   */
+  const T & operator [] (uint32_t i) const
+  {
+    return m_data[i];
+  }
+
+  /**
+   * Append an element.
+   * \param [in] value The element.
+   */
+  void push_back (const T &value);
+  /**
+   * Remove an element, keeping the order of the others.
+   * \param [in] i The element to remove.
+   * \returns An iterator to the element which followed \p i.
+   */
+  iterator erase (iterator i);
+  /** Remove all the elements. */
+  void clear (void);
+
+private:
+  T m_inline[N];        //!< The first N elements.
+  T *m_data;            //!< The elements: m_inline, or an allocated array.
+  uint32_t m_size;      //!< The number of elements.
+  uint32_t m_capacity;  //!< The size of m_data.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T, uint32_t N>
+SmallVector<T,N>::SmallVector ()
+  : m_data (m_inline),
+    m_size (0),
+    m_capacity (N)
+{
+}
+
+template <typename T, uint32_t N>
+SmallVector<T,N>::SmallVector (const SmallVector &o)
+  : m_data (m_inline),
+    m_size (0),
+    m_capacity (N)
+{
+  *this = o;
+}
+
+template <typename T, uint32_t N>
+SmallVector<T,N> &
+SmallVector<T,N>::operator = (const SmallVector &o)
+{
+  if (this != &o)
+    {
+      clear ();
+      for (const_iterator i = o.begin (); i != o.end (); ++i)
+        {
+          push_back (*i);
+        }
+    }
+  return *this;
+}
+
+template <typename T, uint32_t N>
+SmallVector<T,N>::~SmallVector ()
+{
+  if (m_data != m_inline)
+    {
+      delete [] m_data;
+    }
+}
+
+template <typename T, uint32_t N>
+void
+SmallVector<T,N>::push_back (const T &value)
+{
+  if (m_size == m_capacity)
+    {
+      // Copy first: value may be an element of this array
+      T copy = value;
+      uint32_t size = m_size;
+      uint32_t capacity = 2 * m_capacity;
+      T *data = new T[capacity];
+      for (uint32_t i = 0; i < size; i++)
+        {
+          data[i] = m_data[i];
+        }
+      clear ();
+      m_data = data;
+      m_size = size;
+      m_capacity = capacity;
+      m_data[m_size++] = copy;
+      return;
+    }
+  m_data[m_size++] = value;
+}
+
+template <typename T, uint32_t N>
+typename SmallVector<T,N>::iterator
+SmallVector<T,N>::erase (iterator i)
+{
+  for (iterator j = i; j + 1 != end (); ++j)
+    {
+      *j = *(j + 1);
+    }
+  m_size--;
+  m_data[m_size] = T ();
+  return i;
+}
+
+template <typename T, uint32_t N>
+void
+SmallVector<T,N>::clear (void)
+{
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      m_data[i] = T ();
+    }
+  if (m_data != m_inline)
+    {
+      delete [] m_data;
+      m_data = m_inline;
+      m_capacity = N;
+    }
+  m_size = 0;
+}
+
+} // namespace ns3
+
+#endif /* SMALL_VECTOR_H */
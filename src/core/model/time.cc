@@ -68,6 +68,10 @@ bool Time::StaticInit ()
 
   if (firstTime)
     {
+#ifdef NS3_FIXED_TIME_RESOLUTION
+      // The resolution cannot change: nothing to record
+      NS_LOG_LOGIC ("resolution fixed to " << (int) Time::NS3_FIXED_TIME_RESOLUTION);
+#else
       if (! g_markingTimes)
         {
           static MarkedTimes markingTimes;
@@ -77,6 +81,7 @@ bool Time::StaticInit ()
         {
           NS_LOG_ERROR ("firstTime but g_markingTimes != 0");
         }
+#endif /* NS3_FIXED_TIME_RESOLUTION */
 
       // Schedule the cleanup.
       // We'd really like:
@@ -159,10 +164,7 @@ Time::Time (const std::string& s)
       *this = Time::FromDouble (v, Time::S);
     }
 
-  if (g_markingTimes)
-    {
-      Mark (this);
-    }
+  MarkIfNeeded ();
 }
 
 // static
@@ -171,7 +173,11 @@ Time::SetDefaultNsResolution (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
   struct Resolution resolution;
+#ifdef NS3_FIXED_TIME_RESOLUTION
+  SetResolution (Time::NS3_FIXED_TIME_RESOLUTION, &resolution, false);
+#else
   SetResolution (Time::NS, &resolution, false);
+#endif
   return resolution;
 }
 
@@ -180,7 +186,16 @@ void
 Time::SetResolution (enum Unit resolution)
 {
   NS_LOG_FUNCTION (resolution);
+#ifdef NS3_FIXED_TIME_RESOLUTION
+  if (resolution != Time::NS3_FIXED_TIME_RESOLUTION)
+    {
+      NS_FATAL_ERROR ("Time resolution is fixed at build time to unit "
+                      << (int) Time::NS3_FIXED_TIME_RESOLUTION
+                      << ", cannot set unit " << (int) resolution);
+    }
+#else
   SetResolution (resolution, PeekResolution ());
+#endif
 }
 
 
@@ -25,6 +25,7 @@
 #include "type-traits.h"
 #include "fatal-error.h"
 #include "int-to-type.h"
+#include "event-pool.h"
 
 /**
  * \file
@@ -46,6 +47,26 @@ public:
   virtual ~TimerImpl ()
   {
   }
+  /**
+   * Allocate a timer implementation from the EventPool of the calling thread.
+   *
+   * \param [in] size The size of the TimerImpl subclass.
+   * \returns The memory of the timer implementation.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return EventPool::Allocate (size);
+  }
+  /**
+   * Return a timer implementation to the EventPool of the calling thread.
+   *
+   * \param [in] p The memory of the timer implementation.
+   * \param [in] size The size of the TimerImpl subclass.
+   */
+  static void operator delete (void *p, std::size_t size)
+  {
+    EventPool::Deallocate (p, size);
+  }
 
   /**
    * Set the arguments to be used when invoking the expire function.
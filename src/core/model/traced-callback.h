@@ -21,8 +21,8 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
 #include "callback.h"
+#include "small-vector.h"
 
 /**
  * \file
@@ -44,7 +44,9 @@ namespace ns3 {
  *
  * This is a functor: the chain of Callbacks is invoked by
  * calling one of the \c operator() forms with the appropriate
- * number of arguments.
+ * number of arguments.  A Callback may disconnect itself, or any
+ * other Callback, while it is invoked: the remaining Callbacks of
+ * the chain are still invoked.
  *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
@@ -64,6 +66,21 @@ class TracedCallback
 public:
   /** Constructor. */
   TracedCallback ();
+  /**
+   * Copy constructor, which copies the chain but not the invocations
+   * in progress.
+   *
+   * \param [in] o The TracedCallback to copy.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * Assignment operator, which copies the chain but not the invocations
+   * in progress.
+   *
+   * \param [in] o The TracedCallback to copy.
+   * \returns This TracedCallback.
+   */
+  TracedCallback & operator = (const TracedCallback &o);
   /**
    * Append a Callback to the chain (without a context).
    *
@@ -93,6 +110,16 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check for an empty chain, to skip the preparation of the arguments
+   * of a trace which nothing is connected to.
+   *
+   * \returns \c true if no Callback is connected.
+   */
+  bool IsEmpty (void) const
+  {
+    return m_callbackList.empty ();
+  }
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -234,9 +261,20 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
+  typedef SmallVector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8>, 2> CallbackList;
+  /** The chain of Callbacks, stored in the object up to two. */
   CallbackList m_callbackList;
+
+  /** The position of an invocation of the chain in progress. */
+  struct Cursor
+  {
+    uint32_t next;   //!< The index of the next Callback to invoke.
+    /** The Callback being invoked, kept alive if it is disconnected. */
+    Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> current;
+    Cursor *outer;   //!< The enclosing invocation, if the chain is invoked recursively.
+  };
+  /** The innermost invocation in progress, or 0. */
+  mutable Cursor *m_cursor;
 };
 
 } // namespace ns3
@@ -253,8 +291,28 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_callbackList (),
+    m_cursor (0)
+{
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_callbackList (o.m_callbackList),
+    m_cursor (0)
+{
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
 {
+  m_callbackList = o.m_callbackList;
+  return *this;
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -288,17 +346,27 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  for (uint32_t i = 0; i < m_callbackList.size (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (!m_callbackList[i].IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          i++;
+          continue;
         }
-      else
+      // Invocations in progress resume with the Callback following the
+      // erased one
+      for (Cursor *c = m_cursor; c != 0; c = c->outer)
         {
-          i++;
+          if (c->next == i + 1)
+            {
+              c->current = m_callbackList[i];
+            }
+          if (c->next > i)
+            {
+              c->next--;
+            }
         }
+      m_callbackList.erase (m_callbackList.begin () + i);
     }
 }
 template<typename T1, typename T2, 
@@ -321,11 +389,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)();
+      m_callbackList[cursor.next++]();
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -334,11 +404,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1);
+      m_callbackList[cursor.next++](a1);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -347,11 +419,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2);
+      m_callbackList[cursor.next++](a1, a2);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -360,11 +434,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3);
+      m_callbackList[cursor.next++](a1, a2, a3);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -373,11 +449,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3, a4);
+      m_callbackList[cursor.next++](a1, a2, a3, a4);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -386,11 +464,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3, a4, a5);
+      m_callbackList[cursor.next++](a1, a2, a3, a4, a5);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -399,11 +479,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      m_callbackList[cursor.next++](a1, a2, a3, a4, a5, a6);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -412,11 +494,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      m_callbackList[cursor.next++](a1, a2, a3, a4, a5, a6, a7);
     }
+  m_cursor = cursor.outer;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -425,11 +509,13 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  Cursor cursor = { 0, Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> (), m_cursor };
+  m_cursor = &cursor;
+  while (cursor.next < m_callbackList.size ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      m_callbackList[cursor.next++](a1, a2, a3, a4, a5, a6, a7, a8);
     }
+  m_cursor = cursor.outer;
 }
 
 } // namespace ns3
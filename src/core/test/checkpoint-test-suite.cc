@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+class CheckpointForkTestCase : public TestCase
+{
+public:
+  CheckpointForkTestCase ();
+  virtual void DoRun (void);
+  /** Count one tick and schedule the next one. */
+  void Tick (void);
+  /** Fork the branches, which change the increment of the ticks. */
+  void Fork (void);
+  /**
+   * \param [in] branch A branch index.
+   * \returns The file receiving the results of \p branch.
+   */
+  std::string GetFilename (uint32_t branch);
+
+  static const uint32_t BRANCHES = 3;
+  uint32_t m_increment;
+  uint32_t m_ticks;
+  double m_draw;
+  Ptr<UniformRandomVariable> m_random;
+};
+
+CheckpointForkTestCase::CheckpointForkTestCase ()
+  : TestCase ("Check that branches continue from the state at the fork")
+{
+}
+
+void
+CheckpointForkTestCase::Tick (void)
+{
+  m_ticks += m_increment;
+  m_random->GetValue ();
+  if (Simulator::Now () < Seconds (10))
+    {
+      Simulator::Schedule (Seconds (1), &CheckpointForkTestCase::Tick, this);
+    }
+}
+
+void
+CheckpointForkTestCase::Fork (void)
+{
+  uint32_t branch = Checkpoint::Fork (BRANCHES);
+  if (branch != Checkpoint::PARENT)
+    {
+      m_increment = 10 * (branch + 1);
+      // The same in all branches: the stream position is inherited
+      m_draw = m_random->GetValue ();
+    }
+}
+
+std::string
+CheckpointForkTestCase::GetFilename (uint32_t branch)
+{
+  std::ostringstream oss;
+  oss << "branch-" << branch;
+  return CreateTempDirFilename (oss.str ());
+}
+
+void
+CheckpointForkTestCase::DoRun (void)
+{
+  m_increment = 1;
+  m_ticks = 0;
+  m_draw = 0;
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  Simulator::Schedule (Seconds (1), &CheckpointForkTestCase::Tick, this);
+  Simulator::Schedule (Seconds (5.5), &CheckpointForkTestCase::Fork, this);
+  Simulator::Run ();
+
+  if (Checkpoint::IsBranch ())
+    {
+      std::ofstream out (GetFilename (Checkpoint::GetBranch ()).c_str ());
+      out << m_ticks << " " << Simulator::Now ().GetSeconds () << " " << m_draw << std::endl;
+      out.close ();
+      Simulator::Destroy ();
+      Checkpoint::Exit (0);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), 0, "All branches exited normally");
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 5, "Parent stopped at the fork");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (5.5), "Parent stopped at the fork");
+  Simulator::Destroy ();
+
+  double firstDraw = 0;
+  for (uint32_t branch = 0; branch < BRANCHES; branch++)
+    {
+      std::ifstream in (GetFilename (branch).c_str ());
+      uint32_t ticks = 0;
+      double end = 0;
+      double draw = 0;
+      in >> ticks >> end >> draw;
+      NS_TEST_EXPECT_MSG_EQ (ticks, 5 + 5 * 10 * (branch + 1), "Ticks of branch " << branch);
+      NS_TEST_EXPECT_MSG_EQ (end, 10, "End of branch " << branch);
+      if (branch == 0)
+        {
+          firstDraw = draw;
+        }
+      NS_TEST_EXPECT_MSG_EQ (draw, firstDraw, "Random stream of branch " << branch);
+    }
+}
+
+class CheckpointTraceTestCase : public TestCase
+{
+public:
+  CheckpointTraceTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  std::string m_filename;
+};
+
+CheckpointTraceTestCase::CheckpointTraceTestCase ()
+  : TestCase ("Check that branches do not write the buffered traces again")
+{
+}
+
+void
+CheckpointTraceTestCase::DoRun (void)
+{
+  m_filename = CreateTempDirFilename ("checkpoint.tr");
+  // Registered like the pcap and ascii trace files
+  std::ofstream trace (m_filename.c_str ());
+  FatalImpl::RegisterStream (&trace);
+  trace << "before the fork" << std::endl;
+  trace << "buffered";
+
+  if (Checkpoint::Fork (2) != Checkpoint::PARENT)
+    {
+      // Writes what the stream of the branch holds
+      FatalImpl::UnregisterStream (&trace);
+      trace.close ();
+      Checkpoint::Exit (0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), 0, "All branches exited normally");
+  FatalImpl::UnregisterStream (&trace);
+  trace.close ();
+  Simulator::Destroy ();
+
+  std::ifstream in (m_filename.c_str ());
+  std::ostringstream got;
+  got << in.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (got.str (), "before the fork\nbuffered", "Buffered output written once");
+}
+
+void
+CheckpointTraceTestCase::DoTeardown (void)
+{
+  std::remove (m_filename.c_str ());
+}
+
+class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ()
+    : TestSuite ("checkpoint", UNIT)
+  {
+    AddTestCase (new CheckpointForkTestCase (), TestCase::QUICK);
+    AddTestCase (new CheckpointTraceTestCase (), TestCase::QUICK);
+  }
+} g_checkpointTestSuite;
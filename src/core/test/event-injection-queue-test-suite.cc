@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-injection-queue.h"
+#include "ns3/system-thread.h"
+#include "ns3/test.h"
+
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+class EventInjectionQueueOrderTestCase : public TestCase
+{
+public:
+  EventInjectionQueueOrderTestCase ();
+  virtual void DoRun (void);
+};
+
+EventInjectionQueueOrderTestCase::EventInjectionQueueOrderTestCase ()
+  : TestCase ("Check the order of the entries, in the ring and in the overflow list")
+{
+}
+
+void
+EventInjectionQueueOrderTestCase::DoRun (void)
+{
+  EventInjectionQueue queue (4);
+  std::vector<EventInjectionQueue::Entry> entries;
+  NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "New queue");
+  NS_TEST_EXPECT_MSG_EQ (queue.Drain (entries), 0, "Nothing to drain");
+
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          EventInjectionQueue::Entry entry;
+          entry.event = 0;
+          entry.ts = round * 10 + i;
+          entry.context = i;
+          queue.Push (entry);
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), false, "Entries pushed");
+      entries.clear ();
+      NS_TEST_EXPECT_MSG_EQ (queue.Drain (entries), 10, "All entries drained");
+      NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "Queue drained");
+      for (uint32_t i = 0; i < entries.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (entries[i].ts, round * 10 + i, "Push order");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue.GetOverflows (), 18, "Entries beyond the capacity overflow");
+}
+
+/// Number of producer threads
+static const uint32_t PRODUCERS = 4;
+/// Number of entries pushed by each producer
+static const uint32_t ENTRIES = 100000;
+
+class EventInjectionQueueThreadsTestCase : public TestCase
+{
+public:
+  EventInjectionQueueThreadsTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Push the entries of a producer.
+   *
+   * \param [in] context The test case and the producer index, stored as
+   *   the context of the entries.
+   */
+  static void Produce (std::pair<EventInjectionQueueThreadsTestCase *, uint32_t> context);
+
+  EventInjectionQueue m_queue;
+};
+
+EventInjectionQueueThreadsTestCase::EventInjectionQueueThreadsTestCase ()
+  : TestCase ("Check that the entries of concurrent producers are all drained in order"),
+    m_queue (64)
+{
+}
+
+void
+EventInjectionQueueThreadsTestCase::Produce (std::pair<EventInjectionQueueThreadsTestCase *, uint32_t> context)
+{
+  EventInjectionQueueThreadsTestCase *me = context.first;
+  uint32_t producer = context.second;
+  for (uint32_t i = 0; i < ENTRIES; i++)
+    {
+      EventInjectionQueue::Entry entry;
+      entry.event = 0;
+      entry.ts = i;
+      entry.context = producer;
+      me->m_queue.Push (entry);
+    }
+}
+
+void
+EventInjectionQueueThreadsTestCase::DoRun (void)
+{
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&EventInjectionQueueThreadsTestCase::Produce,
+                                                                  std::make_pair (this, p))));
+      threads.back ()->Start ();
+    }
+
+  std::vector<uint64_t> next (PRODUCERS, 0);
+  std::vector<EventInjectionQueue::Entry> entries;
+  uint64_t total = 0;
+  bool ordered = true;
+  while (total < PRODUCERS * ENTRIES)
+    {
+      entries.clear ();
+      total += m_queue.Drain (entries);
+      for (uint32_t i = 0; i < entries.size (); i++)
+        {
+          uint32_t p = entries[i].context;
+          if (p >= PRODUCERS || entries[i].ts != next[p])
+            {
+              ordered = false;
+              break;
+            }
+          next[p]++;
+        }
+    }
+  for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+      threads[p]->Join ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Entries of each producer in push order");
+  NS_TEST_EXPECT_MSG_EQ (total, PRODUCERS * ENTRIES, "No entry lost");
+  entries.clear ();
+  NS_TEST_EXPECT_MSG_EQ (m_queue.Drain (entries), 0, "No entry duplicated");
+}
+
+class EventInjectionQueueTestSuite : public TestSuite
+{
+public:
+  EventInjectionQueueTestSuite ()
+    : TestSuite ("event-injection-queue", UNIT)
+  {
+    AddTestCase (new EventInjectionQueueOrderTestCase (), TestCase::QUICK);
+    AddTestCase (new EventInjectionQueueThreadsTestCase (), TestCase::QUICK);
+  }
+} g_eventInjectionQueueTestSuite;
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-pool.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/timer.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+
+using namespace ns3;
+
+class EventPoolAllocateTestCase : public TestCase
+{
+public:
+  EventPoolAllocateTestCase ();
+  virtual void DoRun (void);
+};
+
+EventPoolAllocateTestCase::EventPoolAllocateTestCase ()
+  : TestCase ("Check that freed blocks are recycled by size class")
+{
+}
+
+void
+EventPoolAllocateTestCase::DoRun (void)
+{
+  EventPool::ResetStats ();
+  void *a = EventPool::Allocate (40);
+  EventPool::Deallocate (a, 40);
+  void *b = EventPool::Allocate (33);
+  NS_TEST_EXPECT_MSG_EQ (b, a, "Blocks of the same size class are recycled");
+  NS_TEST_EXPECT_MSG_GT (EventPool::GetStats ().hits, 0, "Recycled block counted as a hit");
+  void *c = EventPool::Allocate (48);
+  NS_TEST_EXPECT_MSG_NE (c, b, "Distinct blocks");
+  EventPool::Deallocate (c, 48);
+  EventPool::Deallocate (b, 33);
+
+  EventPool::ResetStats ();
+  void *big = EventPool::Allocate (EventPool::GRANULARITY * EventPool::N_CLASSES + 1);
+  EventPool::Deallocate (big, EventPool::GRANULARITY * EventPool::N_CLASSES + 1);
+  EventPool::Stats stats = EventPool::GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 1, "Large blocks are not pooled");
+  NS_TEST_EXPECT_MSG_EQ (stats.releases, 1, "Large blocks are freed");
+}
+
+class EventPoolSimulatorTestCase : public TestCase
+{
+public:
+  EventPoolSimulatorTestCase ();
+  virtual void DoRun (void);
+  void Handler (int a, double b);
+  uint32_t m_count;
+};
+
+EventPoolSimulatorTestCase::EventPoolSimulatorTestCase ()
+  : TestCase ("Check that events and timers are allocated from the pool"),
+    m_count (0)
+{
+}
+
+void
+EventPoolSimulatorTestCase::Handler (int a, double b)
+{
+  m_count++;
+}
+
+void
+EventPoolSimulatorTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolSimulatorTestCase::Handler, this, 1, 2.0);
+    }
+  Simulator::Run ();
+
+  // The events of the first run are free now
+  EventPool::ResetStats ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &EventPoolSimulatorTestCase::Handler, this, 1, 2.0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventPool::GetStats ().misses, 0, "Scheduled events reuse freed events");
+  NS_TEST_EXPECT_MSG_EQ (EventPool::GetStats ().hits, 100, "One block per event");
+  Simulator::Run ();
+
+  EventPool::ResetStats ();
+  Timer timer;
+  timer.SetFunction (&EventPoolSimulatorTestCase::Handler, this);
+  timer.SetArguments (3, 4.0);
+  timer.Schedule (Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (EventPool::GetStats ().hits + EventPool::GetStats ().misses, 2,
+                         "Timer implementation and its event come from the pool");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 201, "All events ran");
+  Simulator::Destroy ();
+}
+
+#ifdef HAVE_PTHREAD_H
+class EventPoolThreadTestCase : public TestCase
+{
+public:
+  EventPoolThreadTestCase ();
+  virtual void DoRun (void);
+  void Allocate (void);
+  EventPool::Stats m_stats;
+};
+
+EventPoolThreadTestCase::EventPoolThreadTestCase ()
+  : TestCase ("Check that each thread has its own pool")
+{
+}
+
+void
+EventPoolThreadTestCase::Allocate (void)
+{
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      EventPool::Deallocate (EventPool::Allocate (64), 64);
+    }
+  m_stats = EventPool::GetStats ();
+}
+
+void
+EventPoolThreadTestCase::DoRun (void)
+{
+  EventPool::ResetStats ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&EventPoolThreadTestCase::Allocate, this));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (m_stats.misses, 1, "A new thread starts with empty free lists");
+  NS_TEST_EXPECT_MSG_EQ (m_stats.hits, 9, "The thread recycles its own blocks");
+  NS_TEST_EXPECT_MSG_EQ (EventPool::GetStats ().hits + EventPool::GetStats ().misses, 0,
+                         "Counters are per thread");
+}
+#endif /* HAVE_PTHREAD_H */
+
+class EventPoolTestSuite : public TestSuite
+{
+public:
+  EventPoolTestSuite ()
+    : TestSuite ("event-pool")
+  {
+    AddTestCase (new EventPoolAllocateTestCase (), TestCase::QUICK);
+    AddTestCase (new EventPoolSimulatorTestCase (), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new EventPoolThreadTestCase (), TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
+  }
+} g_eventPoolTestSuite;
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/** A component of which only the errors and warnings are compiled in. */
+LogComponentWithCeiling<LOG_LEVEL_WARN> g_warnOnly ("LogTestWarnOnly", __FILE__);
+
+} // unnamed namespace
+
+class LogCeilingTestCase : public TestCase
+{
+public:
+  LogCeilingTestCase ();
+  virtual void DoRun (void);
+};
+
+LogCeilingTestCase::LogCeilingTestCase ()
+  : TestCase ("Check that the levels above the ceiling cannot be enabled")
+{
+}
+
+void
+LogCeilingTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogTestWarnOnly", LOG_LEVEL_ALL);
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsEnabled (LOG_ERROR), true, "errors are compiled in");
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsEnabled (LOG_WARN), true, "warnings are compiled in");
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsEnabled (LOG_DEBUG), false, "debug is above the ceiling");
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsEnabled (LOG_FUNCTION), false, "function is above the ceiling");
+  // The base class reads the levels actually enabled
+  const LogComponent &base = g_warnOnly;
+  NS_TEST_EXPECT_MSG_EQ (base.IsEnabled (LOG_LOGIC), false, "logic is masked");
+
+  LogComponentDisable ("LogTestWarnOnly", LOG_LEVEL_ALL);
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsEnabled (LOG_ERROR), false, "disabled");
+  NS_TEST_EXPECT_MSG_EQ (g_warnOnly.IsNoneEnabled (), true, "disabled");
+}
+
+class LogBufferTestCase : public TestCase
+{
+public:
+  LogBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+LogBufferTestCase::LogBufferTestCase ()
+  : TestCase ("Check the buffering of the logging output")
+{
+}
+
+void
+LogBufferTestCase::DoRun (void)
+{
+  std::ostringstream out;
+  std::streambuf *saved = std::clog.rdbuf (out.rdbuf ());
+
+  LogSetBufferSize (64);
+  std::clog << "first message" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (out.str (), "", "a short message stays in the buffer");
+  std::clog << "a second message, long enough to fill the buffer of 64 bytes" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (out.str (), "first message\na second message, long enough to fill the buffer of 64 bytes\n",
+                         "a full buffer is written");
+  std::clog << "third message" << std::endl;
+  LogFlush ();
+  NS_TEST_EXPECT_MSG_EQ (out.str ().substr (out.str ().size () - 14), "third message\n",
+                         "LogFlush writes the buffer");
+
+  LogSetBufferSize (0);
+  NS_TEST_EXPECT_MSG_EQ (std::clog.rdbuf (), out.rdbuf (), "std::clog is restored");
+  std::clog << "direct" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (out.str ().substr (out.str ().size () - 7), "direct\n", "not buffered");
+
+  std::clog.rdbuf (saved);
+}
+
+#ifdef HAVE_PTHREAD_H
+class LogBufferThreadsTestCase : public TestCase
+{
+public:
+  LogBufferThreadsTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Log lines made of one letter.
+   * \param [in] letter The letter of the calling thread.
+   */
+  static void Log (char letter);
+  static const uint32_t THREADS = 4;
+  static const uint32_t LINES = 2000;
+  static const uint32_t LENGTH = 20;
+};
+
+LogBufferThreadsTestCase::LogBufferThreadsTestCase ()
+  : TestCase ("Check that LogFlush does not lose the output of other threads")
+{
+}
+
+void
+LogBufferThreadsTestCase::Log (char letter)
+{
+  std::string line (LENGTH, letter);
+  for (uint32_t i = 0; i < LINES; i++)
+    {
+      std::clog << line << std::endl;
+    }
+}
+
+void
+LogBufferThreadsTestCase::DoRun (void)
+{
+  std::ostringstream out;
+  std::streambuf *saved = std::clog.rdbuf (out.rdbuf ());
+
+  LogSetBufferSize (4096);
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < THREADS; t++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&LogBufferThreadsTestCase::Log, static_cast<char> ('a' + t))));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      // Writes the buffers while their threads append
+      LogFlush ();
+    }
+  for (uint32_t t = 0; t < THREADS; t++)
+    {
+      threads[t]->Join ();
+    }
+  LogSetBufferSize (0);
+  std::clog.rdbuf (saved);
+
+  std::string got = out.str ();
+  for (uint32_t t = 0; t < THREADS; t++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (std::count (got.begin (), got.end (), 'a' + t)), LINES * LENGTH,
+                             "Output of thread " << t);
+    }
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (std::count (got.begin (), got.end (), '\n')), THREADS * LINES, "Lines");
+}
+#endif /* HAVE_PTHREAD_H */
+
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ()
+    : TestSuite ("log", UNIT)
+  {
+    AddTestCase (new LogCeilingTestCase (), TestCase::QUICK);
+    AddTestCase (new LogBufferTestCase (), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new LogBufferThreadsTestCase (), TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
+  }
+} g_logTestSuite;
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Check that GetValues returns the values of successive GetValue calls,
+ * and leaves the stream where they would.
+ */
+class RandomVariableStreamGetValuesTestCase : public TestCase
+{
+public:
+  /**
+   * \param [in] factory The factory of the two random variables compared.
+   * \param [in] name The distribution name.
+   */
+  RandomVariableStreamGetValuesTestCase (ObjectFactory factory, std::string name);
+
+private:
+  virtual void DoRun (void);
+  /** \returns A new random variable using stream 42. */
+  Ptr<RandomVariableStream> Create (void);
+
+  ObjectFactory m_factory;
+};
+
+RandomVariableStreamGetValuesTestCase::RandomVariableStreamGetValuesTestCase (ObjectFactory factory,
+                                                                              std::string name)
+  : TestCase ("Check GetValues of " + name),
+    m_factory (factory)
+{
+}
+
+Ptr<RandomVariableStream>
+RandomVariableStreamGetValuesTestCase::Create (void)
+{
+  Ptr<RandomVariableStream> rv = m_factory.Create<RandomVariableStream> ();
+  rv->SetStream (42);
+  return rv;
+}
+
+void
+RandomVariableStreamGetValuesTestCase::DoRun (void)
+{
+  Ptr<RandomVariableStream> one = Create ();
+  Ptr<RandomVariableStream> bulk = Create ();
+
+  uint32_t sizes[] = { 1, 0, 7, 1000, 3 };
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+    {
+      std::vector<double> values (sizes[s] + 1, -1);
+      bulk->GetValues (&values[0], sizes[s]);
+      for (uint32_t i = 0; i < sizes[s]; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], one->GetValue (), "value " << i << " of batch " << s);
+        }
+      NS_TEST_ASSERT_MSG_EQ (values[sizes[s]], -1, "batch " << s << " overflows");
+    }
+  NS_TEST_ASSERT_MSG_EQ (bulk->GetValue (), one->GetValue (), "GetValue after GetValues");
+}
+
+class RandomVariableStreamGetValuesTestSuite : public TestSuite
+{
+public:
+  RandomVariableStreamGetValuesTestSuite ();
+private:
+  /**
+   * Add a test case.
+   *
+   * \param [in] type The random variable TypeId name.
+   * \param [in] antithetic Whether to generate antithetic values.
+   * \param [in] name The distribution name.
+   * \param [in] n1 The name of the first attribute, or an empty string.
+   * \param [in] v1 The value of the first attribute.
+   * \param [in] n2 The name of the second attribute, or an empty string.
+   * \param [in] v2 The value of the second attribute.
+   */
+  void Add (std::string type, bool antithetic, std::string name,
+            std::string n1 = "", double v1 = 0,
+            std::string n2 = "", double v2 = 0);
+};
+
+void
+RandomVariableStreamGetValuesTestSuite::Add (std::string type, bool antithetic, std::string name,
+                                             std::string n1, double v1,
+                                             std::string n2, double v2)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  factory.Set ("Antithetic", BooleanValue (antithetic));
+  if (!n1.empty ())
+    {
+      factory.Set (n1, DoubleValue (v1));
+    }
+  if (!n2.empty ())
+    {
+      factory.Set (n2, DoubleValue (v2));
+    }
+  AddTestCase (new RandomVariableStreamGetValuesTestCase (factory, name), TestCase::QUICK);
+}
+
+RandomVariableStreamGetValuesTestSuite::RandomVariableStreamGetValuesTestSuite ()
+  : TestSuite ("random-variable-stream-get-values", UNIT)
+{
+  Add ("ns3::UniformRandomVariable", false, "uniform", "Min", -3, "Max", 5);
+  Add ("ns3::UniformRandomVariable", true, "antithetic uniform", "Min", -3, "Max", 5);
+  Add ("ns3::ConstantRandomVariable", false, "constant", "Constant", 7);
+  Add ("ns3::ExponentialRandomVariable", false, "exponential", "Mean", 2);
+  // Half of the values above the bound are drawn again
+  Add ("ns3::ExponentialRandomVariable", false, "bounded exponential", "Mean", 2, "Bound", 1.4);
+  Add ("ns3::ExponentialRandomVariable", true, "antithetic bounded exponential", "Mean", 2, "Bound", 1.4);
+  // The default implementation
+  Add ("ns3::NormalRandomVariable", false, "normal", "Mean", 1, "Variance", 4);
+}
+
+static RandomVariableStreamGetValuesTestSuite g_randomVariableStreamGetValuesTestSuite;
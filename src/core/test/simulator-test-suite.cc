@@ -23,6 +23,12 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include <fstream>
+#include <set>
+#include <sstream>
 
 using namespace ns3;
 
@@ -168,6 +174,86 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  /// Next value of a linear congruential generator, so that runs are repeatable
+  uint32_t Draw (void);
+  uint32_t m_seed;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check event order under a bursty hold workload with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_seed (1),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+uint32_t
+SchedulerOrderTestCase::Draw (void)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return m_seed >> 8;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  // Reference event set, ordered as the scheduler must return it
+  std::set<std::pair<uint64_t, uint32_t> > expected;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < 6000; i++)
+    {
+      if (i < 2000 || Draw () % 2 == 0)
+        {
+          // Same time events, slotted backoffs and long timers
+          uint32_t kind = Draw () % 10;
+          uint64_t delay = kind < 3 ? 0 : kind < 8 ? 9 * (Draw () % 32) : 1000000 + Draw () % 1000;
+          Scheduler::Event ev = { 0, { now + delay, uid++, 0 } };
+          scheduler->Insert (ev);
+          expected.insert (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+          continue;
+        }
+      if (expected.empty ())
+        {
+          continue;
+        }
+      if (Draw () % 4 == 0)
+        {
+          // Cancel the first event at or after a random time
+          std::set<std::pair<uint64_t, uint32_t> >::iterator j =
+            expected.lower_bound (std::make_pair (now + Draw () % 1000, 0));
+          if (j == expected.end ())
+            {
+              continue;
+            }
+          Scheduler::Event ev = { 0, { j->first, j->second, 0 } };
+          scheduler->Remove (ev);
+          expected.erase (j);
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, expected.begin ()->second, "Wrong next event");
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_ts, expected.begin ()->first, "Wrong event time");
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.begin ()->second, "Wrong event uid");
+      now = next.key.m_ts;
+      expected.erase (expected.begin ());
+    }
+  while (!expected.empty ())
+    {
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.begin ()->second, "Wrong event while draining");
+      expected.erase (expected.begin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Events left in the scheduler");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -459,6 +545,83 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  void Member (uint32_t n);
+  static void Function (void);
+  /**
+   * Find the line of a handler in a report.
+   *
+   * \param [in] filename The report.
+   * \param [in] handler The handler name.
+   * \returns The first line containing \p handler, or an empty string.
+   */
+  static std::string FindLine (std::string filename, std::string handler);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the reports of the event profiler")
+{
+}
+
+void
+EventProfilerTestCase::Member (uint32_t n)
+{
+}
+
+void
+EventProfilerTestCase::Function (void)
+{
+}
+
+std::string
+EventProfilerTestCase::FindLine (std::string filename, std::string handler)
+{
+  std::ifstream file (filename.c_str ());
+  std::string line;
+  while (std::getline (file, line))
+    {
+      if (line.find (handler) != std::string::npos)
+        {
+          return line;
+        }
+    }
+  return "";
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  std::string prefix = CreateTempDirFilename ("event-profile");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileOutput", StringValue (prefix));
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (1), &EventProfilerTestCase::Member, this, i);
+    }
+  EventId removed = Simulator::Schedule (Seconds (2), &EventProfilerTestCase::Member, this, 10);
+  Simulator::ScheduleWithContext (3, Seconds (4), &EventProfilerTestCase::Function);
+  Simulator::Remove (removed);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileOutput", StringValue (""));
+
+  std::string line = FindLine (prefix + ".txt", "EventProfilerTestCase::*)(unsigned int)");
+  NS_TEST_ASSERT_MSG_EQ (line.empty (), false, "Method handler in the report");
+  std::istringstream fields (line);
+  uint64_t count;
+  double percent, total, mean, max, delay;
+  fields >> count >> percent >> total >> mean >> max >> delay;
+  NS_TEST_EXPECT_MSG_EQ (count, 10, "Removed events are not counted");
+  NS_TEST_EXPECT_MSG_EQ_TOL (delay, 1, 1e-9, "Time spent in the event list");
+
+  line = FindLine (prefix + ".folded", "void (*)()");
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 20), "void (*)();context 3", "Function handler in the folded stacks");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +638,11 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
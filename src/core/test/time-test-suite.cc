@@ -89,12 +89,26 @@ TimeSimpleTestCase::DoRun (void)
                          "is 1fs really 1fs ?");
 #endif
 
+#ifdef NS3_FIXED_TIME_RESOLUTION
+  // Nothing records the instances, so Time must stay a plain integer
+  NS_TEST_ASSERT_MSG_EQ (sizeof (Time), sizeof (int64_t), "Time is an int64_t");
+#if (__GNUC__ >= 4)
+  NS_TEST_ASSERT_MSG_EQ (__has_trivial_copy (Time), true, "Time is trivially copyable");
+  NS_TEST_ASSERT_MSG_EQ (__has_trivial_destructor (Time), true, "Time is trivially destructible");
+#endif
+  Time ten = TimeStep (10);
+  Time::SetResolution (Time::NS3_FIXED_TIME_RESOLUTION);
+  NS_TEST_ASSERT_MSG_EQ (Time::GetResolution (), Time::NS3_FIXED_TIME_RESOLUTION,
+                         "resolution is fixed");
+  NS_TEST_ASSERT_MSG_EQ (ten.GetTimeStep (), 10, "setting the fixed resolution is harmless");
+#else
   Time ten = NanoSeconds (10);
   int64_t tenValue = ten.GetInteger ();
   Time::SetResolution (Time::PS);
   int64_t tenKValue = ten.GetInteger ();
   NS_TEST_ASSERT_MSG_EQ (tenValue * 1000, tenKValue,
                          "change resolution to PS");
+#endif
 }
 
 void 
@@ -19,6 +19,8 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 
+#include <algorithm>
+
 using namespace ns3;
 
 class BasicTracedCallbackTestCase : public TestCase
@@ -108,6 +110,179 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ManyTracedCallbackTestCase : public TestCase
+{
+public:
+  ManyTracedCallbackTestCase ();
+  virtual ~ManyTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Record a value.
+   * \param [in] test The test case.
+   * \param [in] i The index of the callback.
+   * \param [in] value The value traced.
+   */
+  static void Cb (ManyTracedCallbackTestCase *test, uint32_t i, uint32_t value);
+  /**
+   * Connect the callback of index \p i to m_trace.
+   * \param [in] i The index of the callback.
+   */
+  void Connect (uint32_t i);
+
+  /** The value received by each callback, or 0. */
+  uint32_t m_received[5];
+  TracedCallback<uint32_t> m_trace;
+};
+
+ManyTracedCallbackTestCase::ManyTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback with more callbacks than stored inline")
+{
+}
+
+void
+ManyTracedCallbackTestCase::Cb (ManyTracedCallbackTestCase *test, uint32_t i, uint32_t value)
+{
+  test->m_received[i] = value;
+}
+
+void
+ManyTracedCallbackTestCase::Connect (uint32_t i)
+{
+  m_trace.ConnectWithoutContext (MakeBoundCallback (&ManyTracedCallbackTestCase::Cb, this, i));
+}
+
+void
+ManyTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Nothing connected");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Connect (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Five callbacks connected");
+
+  std::fill (m_received, m_received + 5, 0);
+  m_trace (1);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_received[i], 1, "Callback " << i << " called");
+    }
+
+  // A copy keeps its own chain
+  TracedCallback<uint32_t> copy = m_trace;
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&ManyTracedCallbackTestCase::Cb, this, 1U));
+  std::fill (m_received, m_received + 5, 0);
+  m_trace (2);
+  NS_TEST_ASSERT_MSG_EQ (m_received[0], 2, "Callback 0 called");
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 0, "Callback 1 disconnected");
+  NS_TEST_ASSERT_MSG_EQ (m_received[2], 2, "Callback 2 called");
+  NS_TEST_ASSERT_MSG_EQ (m_received[4], 2, "Callback 4 called");
+
+  std::fill (m_received, m_received + 5, 0);
+  copy (3);
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 3, "Callback 1 still connected to the copy");
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      m_trace.DisconnectWithoutContext (MakeBoundCallback (&ManyTracedCallbackTestCase::Cb, this, i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "All disconnected");
+}
+
+class DisconnectTracedCallbackTestCase : public TestCase
+{
+public:
+  DisconnectTracedCallbackTestCase ();
+  virtual ~DisconnectTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Count a call and disconnect callbacks depending on the value.
+   * \param [in] test The test case.
+   * \param [in] i The index of the callback.
+   * \param [in] value The value traced.
+   */
+  static void Cb (DisconnectTracedCallbackTestCase *test, uint32_t i, uint32_t value);
+  /**
+   * Disconnect the callback of index \p i from m_trace.
+   * \param [in] i The index of the callback.
+   */
+  void Disconnect (uint32_t i);
+
+  /** The number of calls of each callback. */
+  uint32_t m_calls[4];
+  TracedCallback<uint32_t> m_trace;
+};
+
+DisconnectTracedCallbackTestCase::DisconnectTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback when callbacks disconnect while it is invoked")
+{
+}
+
+void
+DisconnectTracedCallbackTestCase::Cb (DisconnectTracedCallbackTestCase *test, uint32_t i, uint32_t value)
+{
+  test->m_calls[i]++;
+  if (value == 1 && i == 0)
+    {
+      test->Disconnect (0);
+    }
+  if (value == 1 && i == 2)
+    {
+      test->Disconnect (3);
+    }
+  if (value == 3 && i == 1)
+    {
+      test->m_trace (4);
+    }
+  if (value == 4 && i == 2)
+    {
+      test->Disconnect (2);
+    }
+}
+
+void
+DisconnectTracedCallbackTestCase::Disconnect (uint32_t i)
+{
+  m_trace.DisconnectWithoutContext (MakeBoundCallback (&DisconnectTracedCallbackTestCase::Cb, this, i));
+}
+
+void
+DisconnectTracedCallbackTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_trace.ConnectWithoutContext (MakeBoundCallback (&DisconnectTracedCallbackTestCase::Cb, this, i));
+    }
+  std::fill (m_calls, m_calls + 4, 0);
+
+  // Callback 0 disconnects itself, callback 2 the next one
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_calls[0], 1, "Callback 0 called before it disconnects");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[1], 1, "Callback 1 called after callback 0 disconnected");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[2], 1, "Callback 2 called");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[3], 0, "Callback 3 disconnected before its turn");
+
+  m_trace (2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls[0], 1, "Callback 0 disconnected");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[1], 2, "Callback 1 still connected");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[2], 2, "Callback 2 still connected");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[3], 0, "Callback 3 disconnected");
+
+  // Callback 1 invokes the chain again, in which callback 2 disconnects
+  m_trace (3);
+  NS_TEST_ASSERT_MSG_EQ (m_calls[1], 4, "Callback 1 called by both invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[2], 3, "Callback 2 called by the inner invocation only");
+
+  Disconnect (1);
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "All disconnected");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +293,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ManyTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new DisconnectTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
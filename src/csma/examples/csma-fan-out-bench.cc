@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the heap allocations made to deliver a frame on a CSMA LAN.
+ *
+ * The nodes send frames in turn, 1 ms apart, every other frame to the
+ * broadcast address and the others to the next node.  The program counts
+ * the calls to operator new made while the simulation runs, and prints
+ * their number per frame.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+using namespace ns3;
+
+namespace {
+
+/** Number of calls to operator new. */
+uint64_t g_allocations;
+
+/** Send a frame of 100 bytes. */
+void
+Send (Ptr<NetDevice> device, Address to)
+{
+  device->Send (Create<Packet> (100), to, 0x800);
+}
+
+} // unnamed namespace
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 50;
+  uint32_t frames = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes on the LAN", nodes);
+  cmd.AddValue ("frames", "Number of frames sent", frames);
+  cmd.Parse (argc, argv);
+
+  NodeContainer lan;
+  lan.Create (nodes);
+  CsmaHelper csma;
+  NetDeviceContainer devices = csma.Install (lan);
+
+  for (uint32_t i = 0; i < frames; i++)
+    {
+      Address to = (i % 2) ? devices.Get (0)->GetBroadcast ()
+        : devices.Get ((i + 1) % nodes)->GetAddress ();
+      Simulator::Schedule (MilliSeconds (i), &Send, devices.Get (i % nodes), to);
+    }
+
+  uint64_t start = g_allocations;
+  Simulator::Run ();
+  std::cout << "allocations per frame " << (g_allocations - start) / double (frames) << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
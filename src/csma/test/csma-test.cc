@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/error-model.h"
+#include "ns3/socket.h"
+#include "ns3/csma-helper.h"
+#include "ns3/csma-net-device.h"
+
+using namespace ns3;
+
+/**
+ * \brief An error model that tags every packet it sees
+ *
+ * It modifies the packet as a receiver may do with the packet that
+ * CsmaChannel shares between the receivers.
+ */
+class TaggingErrorModel : public ErrorModel
+{
+public:
+  TaggingErrorModel ();
+
+  uint32_t m_seen;   //!< Number of packets seen
+  uint32_t m_intact; //!< Number of packets seen as they were sent
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+};
+
+TaggingErrorModel::TaggingErrorModel ()
+  : m_seen (0), m_intact (0)
+{
+}
+
+bool
+TaggingErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  SocketIpTtlTag tag;
+  m_seen++;
+  // 1000 bytes with the Ethernet header and trailer
+  if (p->GetSize () == 1018 && !p->PeekPacketTag (tag))
+    {
+      m_intact++;
+    }
+  tag.SetTtl (1);
+  p->AddPacketTag (tag);
+  return false;
+}
+
+void
+TaggingErrorModel::DoReset (void)
+{
+}
+
+/**
+ * \brief Test the packet shared by the receivers of CsmaChannel
+ *
+ * Every receiver tags the packet it gets; each must get the packet as
+ * it was sent, whatever the other receivers did to theirs.
+ */
+class CsmaSharedPacketTest : public TestCase
+{
+public:
+  CsmaSharedPacketTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Count the tagged packets passed up by the devices
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the source address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  uint32_t m_count; //!< Number of tagged packets passed up
+};
+
+CsmaSharedPacketTest::CsmaSharedPacketTest ()
+  : TestCase ("Receivers of CsmaChannel modifying the packet they share"),
+    m_count (0)
+{
+}
+
+bool
+CsmaSharedPacketTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  SocketIpTtlTag tag;
+  if (p->GetSize () == 1000 && p->PeekPacketTag (tag))
+    {
+      m_count++;
+    }
+  return true;
+}
+
+void
+CsmaSharedPacketTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  CsmaHelper csma;
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  Ptr<TaggingErrorModel> models[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<CsmaNetDevice> device = DynamicCast<CsmaNetDevice> (devices.Get (i));
+      device->SetReceiveCallback (MakeCallback (&CsmaSharedPacketTest::Receive, this));
+      models[i] = CreateObject<TaggingErrorModel> ();
+      device->SetReceiveErrorModel (models[i]);
+    }
+
+  // The channel passes the packet of the sender to the receivers
+  Ptr<Packet> packet = Create<Packet> (1000);
+  Simulator::Schedule (Seconds (1), &NetDevice::Send, devices.Get (0),
+                       packet, devices.Get (0)->GetBroadcast (), 0x800);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  SocketIpTtlTag tag;
+  NS_TEST_EXPECT_MSG_EQ (models[0]->m_seen, 0, "The sender does not receive its packet");
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (models[i]->m_seen, 1, "Receiver " << i << " got the packet");
+      NS_TEST_EXPECT_MSG_EQ (models[i]->m_intact, 1, "Receiver " << i << " got the packet as it was sent");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_count, 3, "Each receiver passed up its own tagged copy");
+  NS_TEST_EXPECT_MSG_EQ (packet->PeekPacketTag (tag), false, "The packet of the sender has no tag");
+}
+
+/**
+ * \brief TestSuite for the CSMA module
+ */
+class CsmaTestSuite : public TestSuite
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  CsmaTestSuite ();
+};
+
+CsmaTestSuite::CsmaTestSuite ()
+  : TestSuite ("devices-csma", UNIT)
+{
+  AddTestCase (new CsmaSharedPacketTest, TestCase::QUICK);
+}
+
+static CsmaTestSuite g_csmaTestSuite; //!< The test suite
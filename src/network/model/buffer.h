@@ -559,6 +559,16 @@ private:
    * start of this Buffer.
    */
   inline Buffer::Iterator Begin (void) const;
+  /**
+   * \return an Iterator which points to the
+   * start of this Buffer and can overwrite its bytes.
+   *
+   * The bytes are first copied if they are shared with another
+   * Buffer, so that writes do not show through copies of this Buffer.
+   * Any call to this method invalidates any Iterator
+   * pointing to this Buffer.
+   */
+  Buffer::Iterator BeginWritable (void);
   /**
    * \return an Iterator which points to the
    * end of this Buffer.
@@ -727,11 +737,18 @@ private:
 
   /**
    * \brief Recycle the buffer memory
+   *
+   * With BUFFER_FREE_LIST, the memory returns to the PacketPool.
+   *
    * \param data the buffer data storage
    */
   static void Recycle (struct Buffer::Data *data);
   /**
    * \brief Create a buffer data storage
+   *
+   * With BUFFER_FREE_LIST, the memory comes from the PacketPool and
+   * the storage may be larger than requested.
+   *
    * \param size the storage size to create
    * \returns a pointer to the created buffer storage
    */
@@ -788,19 +805,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
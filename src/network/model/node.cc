@@ -214,18 +214,20 @@ void Node::SetSelfV_value(float e) {
   nodeV_value = e;
 }
 
-void Node::SelfEnergyInDe(uint32_t e, bool i_d) {
+bool Node::SelfEnergyInDe(uint32_t e, bool i_d) {
   // boolean value here indicates the increasement or decreasement:
   // true for adding, false for losing.
   if(i_d==true) {
     nodeEnergy += e;
   }
   else {
-    if(nodeEnergy < e)
-    quick_exit(1);
-    else
+    if(nodeEnergy < e) {
+      nodeEnergy = 0;
+      return false;
+    }
     nodeEnergy -= e;
   }
+  return true;
 }
 
 void 
@@ -149,7 +149,13 @@ public:
 
   void SetSelfV_value (float);
 
-  void SelfEnergyInDe (uint32_t, bool);
+  /**
+   * Add (i_d true) or remove (i_d false) e units of energy.
+   *
+   * \returns false if less than e units were left to remove, the energy
+   * is then set to 0
+   */
+  bool SelfEnergyInDe (uint32_t e, bool i_d);
 
   // End of change, Sept. 28, 2017
 
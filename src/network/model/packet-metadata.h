@@ -74,6 +74,10 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When the metadata is disabled, or when it is sampled and the packet
+ * is not in the sample, no storage is allocated and every operation
+ * returns immediately.
  */
 class PacketMetadata 
 {
@@ -159,6 +163,17 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata of one packet out of \p period
+   *
+   * Only the packets of which the uid is a multiple of \p period
+   * record their metadata; the others cost as little as when the
+   * metadata is disabled.  The uid is kept by the copies and fragments
+   * of a packet, so a packet stays in the sample along its whole path.
+   *
+   * \param period The sampling period; 1 records every packet.
+   */
+  static void EnableSampling (uint32_t period);
 
   /**
    * \brief Constructor
@@ -219,9 +234,15 @@ private:
 
   /**
    * \brief Add a metadata at the metadata start
+   *
+   * If \p o recorded no item, because its packet is not in the sample
+   * or was created before the metadata was enabled, its \p size bytes
+   * are recorded as a single payload fragment of its packet.
+   *
    * \param o the metadata to add
+   * \param size the size of the packet of \p o
    */
-  void AddAtEnd (PacketMetadata const&o);
+  void AddAtEnd (PacketMetadata const&o, uint32_t size);
   /**
    * \brief Add some padding at the end
    * \param end size of padding
@@ -491,16 +512,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -635,11 +646,18 @@ public:
 
   /**
    * \brief Recycle the buffer memory
+   *
+   * The memory returns to the PacketPool.
+   *
    * \param data the buffer data storage
    */
   static void Recycle (struct PacketMetadata::Data *data);
   /**
    * \brief Create a buffer data storage
+   *
+   * The memory comes from the PacketPool and the storage may be
+   * larger than requested.
+   *
    * \param size the storage size to create
    * \returns a pointer to the created buffer storage
    */
@@ -655,10 +673,24 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Check if this packet is in the sample
+   * \returns true if the uid of this packet is a multiple of m_samplePeriod
+   */
+  inline bool IsSampled (void) const;
+  /**
+   * \brief Check if an operation must not be recorded
+   *
+   * Also records that the operation was skipped because the metadata
+   * is disabled.
+   *
+   * \returns true if the metadata is disabled or this packet is not sampled
+   */
+  inline bool IsSkipped (void) const;
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static uint32_t m_samplePeriod; //!< One packet out of m_samplePeriod records its metadata
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -667,8 +699,7 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static uint16_t m_chunkUid; //!< Chunk Uid, incremented atomically
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -687,13 +718,17 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_enable && IsSampled ())
+    {
+      m_data = PacketMetadata::Create (10);
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -706,9 +741,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -716,15 +753,19 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -734,12 +775,29 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
+    {
+      m_data->m_count--;
+      if (m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+    }
+}
+bool
+PacketMetadata::IsSampled (void) const
+{
+  return m_samplePeriod == 1 || m_packetUid % m_samplePeriod == 0;
+}
+bool
+PacketMetadata::IsSkipped (void) const
+{
+  if (!m_enable)
     {
-      PacketMetadata::Recycle (m_data);
+      m_metadataSkipped = true;
+      return true;
     }
+  return !IsSampled ();
 }
 
 } // namespace ns3
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-pool.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketPool implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketPool");
+
+namespace {
+
+/** A free block, linked through its first bytes. */
+struct FreeBlock
+{
+  FreeBlock *next; /**< The next free block of the same size class. */
+};
+
+/** The free lists and counters of a thread. */
+struct Pool
+{
+  FreeBlock *free[PacketPool::N_CLASSES]; /**< Free lists, by size class. */
+  uint32_t bytes[PacketPool::N_CLASSES];  /**< Bytes in the free lists. */
+  PacketPool::Stats stats;                /**< Counters. */
+};
+
+/** The maximum number of bytes of a free list. */
+uint32_t g_maxFreeBytes = 1 << 20;
+
+/**
+ * Return the free blocks of a pool to operator delete.
+ *
+ * \param [in] pool The pool.
+ */
+void
+ReleasePool (Pool *pool)
+{
+  NS_LOG_FUNCTION (pool << pool->stats.hits << pool->stats.misses);
+  for (uint32_t c = 0; c < PacketPool::N_CLASSES; c++)
+    {
+      while (pool->free[c] != 0)
+        {
+          FreeBlock *block = pool->free[c];
+          pool->free[c] = block->next;
+          ::operator delete (block);
+        }
+      pool->bytes[c] = 0;
+    }
+}
+
+/**
+ * Get the size class of a block.
+ *
+ * \param [in] size The size of the block.
+ * \returns The size class, or N_CLASSES if the block is too large.
+ */
+inline uint32_t
+GetClass (uint32_t size)
+{
+  if (size > PacketPool::MAX_SIZE)
+    {
+      return PacketPool::N_CLASSES;
+    }
+  uint32_t c = 0;
+  while ((PacketPool::MIN_SIZE << c) < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/** Key of the pool of each thread. */
+pthread_key_t g_poolKey;
+/** Creates g_poolKey on first use. */
+pthread_once_t g_poolKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Destroy the pool of an exiting thread.
+ *
+ * \param [in] pool The pool.
+ */
+extern "C" void
+DestroyPacketPool (void *pool)
+{
+  ReleasePool (static_cast<Pool *> (pool));
+  delete static_cast<Pool *> (pool);
+}
+
+/** Create g_poolKey. */
+extern "C" void
+CreatePacketPoolKey (void)
+{
+  pthread_key_create (&g_poolKey, &DestroyPacketPool);
+}
+
+/**
+ * Get the pool of the calling thread.
+ *
+ * \returns The pool.
+ */
+inline Pool *
+GetPool (void)
+{
+  pthread_once (&g_poolKeyOnce, &CreatePacketPoolKey);
+  Pool *pool = static_cast<Pool *> (pthread_getspecific (g_poolKey));
+  if (pool == 0)
+    {
+      pool = new Pool ();
+      pthread_setspecific (g_poolKey, pool);
+    }
+  return pool;
+}
+
+#else /* HAVE_PTHREAD_H */
+
+/**
+ * Get the pool of the calling thread.
+ *
+ * \returns The pool.
+ */
+inline Pool *
+GetPool (void)
+{
+  // Never destroyed: packets may be freed by static destructors
+  static Pool *pool = new Pool ();
+  return pool;
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+} // unnamed namespace
+
+void *
+PacketPool::Allocate (uint32_t &size)
+{
+  uint32_t c = GetClass (size);
+  Pool *pool = GetPool ();
+  if (c == N_CLASSES)
+    {
+      pool->stats.misses++;
+      return ::operator new (size);
+    }
+  size = MIN_SIZE << c;
+  FreeBlock *block = pool->free[c];
+  if (block == 0)
+    {
+      pool->stats.misses++;
+      return ::operator new (size);
+    }
+  pool->free[c] = block->next;
+  pool->bytes[c] -= size;
+  pool->stats.hits++;
+  return block;
+}
+
+void
+PacketPool::Deallocate (void *p, uint32_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  uint32_t c = GetClass (size);
+  Pool *pool = GetPool ();
+  if (c == N_CLASSES || pool->bytes[c] + (MIN_SIZE << c) > g_maxFreeBytes)
+    {
+      pool->stats.releases++;
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool->free[c];
+  pool->free[c] = block;
+  pool->bytes[c] += MIN_SIZE << c;
+}
+
+void
+PacketPool::SetMaxFreeBytes (uint32_t bytes)
+{
+  NS_LOG_FUNCTION (bytes);
+  g_maxFreeBytes = bytes;
+}
+
+uint32_t
+PacketPool::GetMaxFreeBytes (void)
+{
+  return g_maxFreeBytes;
+}
+
+PacketPool::Stats
+PacketPool::GetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetPool ()->stats;
+}
+
+void
+PacketPool::ResetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Pool *pool = GetPool ();
+  pool->stats.hits = 0;
+  pool->stats.misses = 0;
+  pool->stats.releases = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief Free list allocator of the storage of packets.
+ *
+ * The data of Buffer, PacketMetadata, PacketTagList and ByteTagList
+ * are taken from this pool, so that the storage of freed packets is
+ * reused by new packets of any size.
+ *
+ * Sizes are rounded up to a power of two, from MIN_SIZE to MAX_SIZE,
+ * and served from one free list per size class; larger blocks go
+ * straight to the global operator new.  Callers which can use the
+ * whole block get its actual size from Allocate.  Each thread has its
+ * own free lists and counters, so the threads of the realtime simulator
+ * and of the application never contend.  A block freed by another
+ * thread than the one which allocated it simply joins the free list of
+ * the freeing thread.  Each free list keeps at most the number of
+ * bytes set by SetMaxFreeBytes.
+ */
+class PacketPool
+{
+public:
+  /** Allocation counters of a thread. */
+  struct Stats
+  {
+    uint64_t hits;     /**< Allocations served from a free list. */
+    uint64_t misses;   /**< Allocations forwarded to operator new. */
+    uint64_t releases; /**< Blocks returned to operator delete. */
+  };
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in,out] size The size of the block, in bytes, rounded up to
+   *        the size actually allocated.
+   * \returns The block.
+   */
+  static void * Allocate (uint32_t &size);
+  /**
+   * Free a block.
+   *
+   * \param [in] p The block returned by Allocate.
+   * \param [in] size The size given to, or returned by, Allocate.
+   */
+  static void Deallocate (void *p, uint32_t size);
+  /**
+   * Set the maximum number of bytes kept by each free list of each
+   * thread.  It should be set before the simulation starts.
+   *
+   * \param [in] bytes The number of bytes; zero disables the free lists.
+   */
+  static void SetMaxFreeBytes (uint32_t bytes);
+  /**
+   * \returns The maximum number of bytes kept by each free list.
+   */
+  static uint32_t GetMaxFreeBytes (void);
+  /**
+   * Get the counters of the calling thread.
+   *
+   * \returns The counters since the thread started or the last ResetStats.
+   */
+  static Stats GetStats (void);
+  /** Reset the counters of the calling thread. */
+  static void ResetStats (void);
+
+  /** Size of the smallest size class, in bytes. */
+  static const uint32_t MIN_SIZE = 32;
+  /** Number of size classes: blocks up to 64 KiB are pooled. */
+  static const uint32_t N_CLASSES = 12;
+  /** Size of the largest size class, in bytes. */
+  static const uint32_t MAX_SIZE = MIN_SIZE << (N_CLASSES - 1);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
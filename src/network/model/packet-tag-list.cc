@@ -24,6 +24,7 @@
 */
 
 #include "packet-tag-list.h"
+#include "packet-pool.h"
 #include "tag-buffer.h"
 #include "tag.h"
 #include "ns3/fatal-error.h"
@@ -34,6 +35,19 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+void *
+PacketTagList::TagData::operator new (std::size_t size)
+{
+  uint32_t blockSize = size;
+  return PacketPool::Allocate (blockSize);
+}
+
+void
+PacketTagList::TagData::operator delete (void *p, std::size_t size)
+{
+  PacketPool::Deallocate (p, size);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
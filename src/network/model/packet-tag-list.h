@@ -26,6 +26,7 @@
 */
 
 #include <stdint.h>
+#include <cstddef>
 #include <ostream>
 #include "ns3/type-id.h"
 
@@ -165,6 +166,19 @@ public:
     struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
     uint32_t count;           /**< Number of incoming links */
+
+    /**
+     * Allocate a TagData from the PacketPool.
+     * \param [in] size The size of a TagData.
+     * \returns The memory of the TagData.
+     */
+    static void * operator new (std::size_t size);
+    /**
+     * Return a TagData to the PacketPool.
+     * \param [in] p The TagData.
+     * \param [in] size The size of a TagData.
+     */
+    static void operator delete (void *p, std::size_t size);
   };  /* struct TagData */
 
   /**
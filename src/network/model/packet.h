@@ -196,7 +196,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. If you need the metadata of a few packets
+ * only, Packet::EnableSampledPrinting records it for one packet
+ * out of N.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -330,6 +332,19 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header) const;
+  /**
+   * \brief Overwrite the header at the start of the packet in place.
+   *
+   * This method invokes Header::Serialize over the bytes of the
+   * header already at the start of the packet, which must have the
+   * same type and serialized size as header. Unlike RemoveHeader
+   * followed by AddHeader, the packet size, byte tags and metadata are
+   * left untouched and the buffer is only copied if it is shared with
+   * another packet.
+   *
+   * \param header a reference to the header to write.
+   */
+  void ReplaceHeader (const Header &header);
   /**
    * \brief Add trailer to this packet.
    *
@@ -493,6 +508,18 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing the metadata of one packet out of \p period.
+   *
+   * Like EnablePrinting, but only the packets of which the uid is a
+   * multiple of \p period keep their metadata: the other packets
+   * cost no more than when the printing is disabled, and print without
+   * their headers and trailers.  A packet keeps its uid across copies
+   * and fragments, hence is printed along its whole path.
+   *
+   * \param [in] period The sampling period; 1 is like EnablePrinting.
+   */
+  static void EnableSampledPrinting (uint32_t period);
   /**
    * \brief Enable packets metadata checking.
    *
@@ -730,7 +757,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /**
+   * Global counter of packets Uid, incremented atomically since packets
+   * may be created by several threads.
+   */
+  static uint32_t m_globalUid;
 };
 
 /**
@@ -757,6 +788,7 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *
  * Dirty operations:
  *   - ns3::Packet::AddHeader
+ *   - ns3::Packet::ReplaceHeader
  *   - ns3::Packet::AddTrailer
  *   - both versions of ns3::Packet::AddAtEnd
  *   - ns3::Packet::RemovePacketTag
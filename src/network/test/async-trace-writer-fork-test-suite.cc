@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/async-trace-writer.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/checkpoint.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace ns3;
+
+class AsyncTraceWriterForkTestCase : public TestCase
+{
+public:
+  AsyncTraceWriterForkTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  /**
+   * \param [in] filename The file to read.
+   * \returns The content of \p filename.
+   */
+  std::string Read (std::string filename);
+
+  std::string m_filenames[2];
+};
+
+AsyncTraceWriterForkTestCase::AsyncTraceWriterForkTestCase ()
+  : TestCase ("Check the background writer across a fork and a fatal error")
+{
+}
+
+std::string
+AsyncTraceWriterForkTestCase::Read (std::string filename)
+{
+  std::ifstream file (filename.c_str ());
+  std::ostringstream got;
+  got << file.rdbuf ();
+  return got.str ();
+}
+
+void
+AsyncTraceWriterForkTestCase::DoRun (void)
+{
+  m_filenames[0] = CreateTempDirFilename ("async-parent.tr");
+  m_filenames[1] = CreateTempDirFilename ("async-branch.tr");
+  std::ostringstream parent;
+  std::ostringstream branch;
+
+  // Small buffers, so that they are swapped many times
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (1024));
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (m_filenames[0], std::ios::out);
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      *stream->GetStream () << "parent " << i << std::endl;
+      parent << "parent " << i << std::endl;
+    }
+
+  if (Checkpoint::Fork (1) != Checkpoint::PARENT)
+    {
+      // The background thread runs again in the branch
+      Ptr<OutputStreamWrapper> out = Create<OutputStreamWrapper> (m_filenames[1], std::ios::out);
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          *out->GetStream () << "branch " << i << std::endl;
+        }
+      // The path of NS_FATAL_ERROR, without closing the file
+      FatalImpl::FlushStreams ();
+      _exit (0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), 0, "The branch exited normally");
+
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      *stream->GetStream () << "after " << i << std::endl;
+      parent << "after " << i << std::endl;
+    }
+  stream = 0;
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (0));
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      branch << "branch " << i << std::endl;
+    }
+  NS_TEST_EXPECT_MSG_EQ (Read (m_filenames[0]), parent.str (), "Parent output written once");
+  NS_TEST_EXPECT_MSG_EQ (Read (m_filenames[1]), branch.str (), "Branch output written on the fatal path");
+}
+
+void
+AsyncTraceWriterForkTestCase::DoTeardown (void)
+{
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      std::remove (m_filenames[f].c_str ());
+    }
+}
+
+class AsyncTraceWriterForkTestSuite : public TestSuite
+{
+public:
+  AsyncTraceWriterForkTestSuite ()
+    : TestSuite ("async-trace-writer-fork", UNIT)
+  {
+    AddTestCase (new AsyncTraceWriterForkTestCase (), TestCase::QUICK);
+  }
+} g_asyncTraceWriterForkTestSuite;
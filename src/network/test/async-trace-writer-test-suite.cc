@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/async-trace-writer.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/pcap-file.h"
+#include "ns3/packet.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace ns3;
+
+class AsyncTraceWriterPcapTestCase : public TestCase
+{
+public:
+  AsyncTraceWriterPcapTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  std::string m_filenames[2];
+};
+
+AsyncTraceWriterPcapTestCase::AsyncTraceWriterPcapTestCase ()
+  : TestCase ("Check the pcap files written in the background")
+{
+}
+
+void
+AsyncTraceWriterPcapTestCase::DoRun (void)
+{
+  // Small buffers, so that they are swapped many times
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (1024));
+  NS_TEST_ASSERT_MSG_EQ (AsyncTraceWriter::GetBufferSize (), 1024, "Writer enabled");
+
+  PcapFile files[2];
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      m_filenames[f] = CreateTempDirFilename (f == 0 ? "async-0.pcap" : "async-1.pcap");
+      files[f].Open (m_filenames[f], std::ios::out);
+      NS_TEST_ASSERT_MSG_EQ (files[f].Fail (), false, "Open " << m_filenames[f]);
+      files[f].Init (1, 100);
+    }
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      uint8_t data[300];
+      uint32_t size = 1 + i % 300;
+      for (uint32_t j = 0; j < size; j++)
+        {
+          data[j] = i + j;
+        }
+      files[i % 2].Write (i, 0, Create<Packet> (data, size));
+    }
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      files[f].Close ();
+    }
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (0));
+
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      PcapFile file;
+      file.Open (m_filenames[f], std::ios::in);
+      NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Read " << m_filenames[f]);
+      NS_TEST_EXPECT_MSG_EQ (file.GetSnapLen (), 100, "File header written");
+      for (uint32_t i = f; i < 200; i += 2)
+        {
+          uint8_t data[300];
+          uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+          file.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+          NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Record " << i << " written");
+          NS_TEST_EXPECT_MSG_EQ (tsSec, i, "Records in order");
+          NS_TEST_EXPECT_MSG_EQ (origLen, 1 + i % 300, "Original length");
+          NS_TEST_EXPECT_MSG_EQ (inclLen, std::min<uint32_t> (origLen, 100), "Truncated to the snaplen");
+          bool same = true;
+          for (uint32_t j = 0; j < readLen; j++)
+            {
+              same &= data[j] == static_cast<uint8_t> (i + j);
+            }
+          NS_TEST_EXPECT_MSG_EQ (same, true, "Record " << i << " data");
+        }
+      uint8_t data[1];
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      file.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_EXPECT_MSG_EQ (file.Eof (), true, "No extra record");
+    }
+}
+
+void
+AsyncTraceWriterPcapTestCase::DoTeardown (void)
+{
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      std::remove (m_filenames[f].c_str ());
+    }
+}
+
+class AsyncTraceWriterAsciiTestCase : public TestCase
+{
+public:
+  AsyncTraceWriterAsciiTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  std::string m_filename;
+};
+
+AsyncTraceWriterAsciiTestCase::AsyncTraceWriterAsciiTestCase ()
+  : TestCase ("Check the ASCII files written in the background")
+{
+}
+
+void
+AsyncTraceWriterAsciiTestCase::DoRun (void)
+{
+  m_filename = CreateTempDirFilename ("async.tr");
+  std::ostringstream expected;
+
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (1024));
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (m_filename, std::ios::out);
+  std::string big (5000, 'x');
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      *stream->GetStream () << "t " << i << " line" << std::endl;
+      expected << "t " << i << " line" << std::endl;
+      if (i % 100 == 0)
+        {
+          // Larger than the buffer of the stream
+          *stream->GetStream () << big << std::endl;
+          expected << big << std::endl;
+        }
+    }
+  stream = 0;
+  GlobalValue::Bind ("AsyncTraceBufferSize", UintegerValue (0));
+
+  std::ifstream file (m_filename.c_str ());
+  std::ostringstream got;
+  got << file.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (got.str ().size (), expected.str ().size (), "Size of the file");
+  NS_TEST_EXPECT_MSG_EQ ((got.str () == expected.str ()), true, "Content of the file");
+}
+
+void
+AsyncTraceWriterAsciiTestCase::DoTeardown (void)
+{
+  std::remove (m_filename.c_str ());
+}
+
+class AsyncTraceWriterTestSuite : public TestSuite
+{
+public:
+  AsyncTraceWriterTestSuite ()
+    : TestSuite ("async-trace-writer", UNIT)
+  {
+    AddTestCase (new AsyncTraceWriterPcapTestCase (), TestCase::QUICK);
+    AddTestCase (new AsyncTraceWriterAsciiTestCase (), TestCase::QUICK);
+  }
+} g_asyncTraceWriterTestSuite;
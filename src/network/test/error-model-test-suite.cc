@@ -39,6 +39,7 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/rng-seed-manager.h"
+#include "ns3/socket.h"
 
 using namespace ns3;
 
@@ -224,6 +225,119 @@ BurstErrorModelSimple::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_drops, 260 , "Wrong number of drops.");
 }
 
+/**
+ * An error model that modifies every packet it sees, as a receiver may
+ * do with the packet that the channel shares between the receivers.
+ */
+class ModifyingErrorModel : public ErrorModel
+{
+public:
+  ModifyingErrorModel ();
+
+  uint32_t m_seen;   //!< Number of packets seen
+  uint32_t m_intact; //!< Number of packets seen as they were sent
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+};
+
+ModifyingErrorModel::ModifyingErrorModel ()
+  : m_seen (0), m_intact (0)
+{
+}
+
+bool
+ModifyingErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  SocketIpTtlTag tag;
+  m_seen++;
+  if (p->GetSize () == 1000 && !p->PeekPacketTag (tag))
+    {
+      m_intact++;
+    }
+  p->RemoveAtStart (100);
+  tag.SetTtl (1);
+  p->AddPacketTag (tag);
+  return false;
+}
+
+void
+ModifyingErrorModel::DoReset (void)
+{
+}
+
+class ErrorModelSharedPacket : public TestCase
+{
+public:
+  ErrorModelSharedPacket ();
+  virtual ~ErrorModelSharedPacket ();
+
+private:
+  virtual void DoRun (void);
+  bool Receive (Ptr<NetDevice> nd, Ptr<const Packet> p, uint16_t protocol, const Address& addr);
+  uint32_t m_count;
+};
+
+ErrorModelSharedPacket::ErrorModelSharedPacket ()
+  : TestCase ("Receivers of SimpleChannel modifying the packet they share"), m_count (0)
+{
+}
+
+ErrorModelSharedPacket::~ErrorModelSharedPacket ()
+{
+}
+
+bool
+ErrorModelSharedPacket::Receive (Ptr<NetDevice> nd, Ptr<const Packet> p, uint16_t protocol, const Address& addr)
+{
+  // Each receiver gets the packet that its own error model modified
+  SocketIpTtlTag tag;
+  if (p->GetSize () == 900 && p->PeekPacketTag (tag))
+    {
+      m_count++;
+    }
+  return true;
+}
+
+void
+ErrorModelSharedPacket::DoRun (void)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> devices[4];
+  Ptr<ModifyingErrorModel> models[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      node->AddDevice (devices[i]);
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      devices[i]->SetChannel (channel);
+      devices[i]->SetNode (node);
+      devices[i]->SetReceiveCallback (MakeCallback (&ErrorModelSharedPacket::Receive, this));
+      models[i] = CreateObject<ModifyingErrorModel> ();
+      devices[i]->SetReceiveErrorModel (models[i]);
+    }
+
+  // The channel passes the packet of the sender to the receivers
+  Ptr<Packet> packet = Create<Packet> (1000);
+  devices[0]->Send (packet, devices[0]->GetBroadcast (), 0);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  SocketIpTtlTag tag;
+  NS_TEST_EXPECT_MSG_EQ (models[0]->m_seen, 0, "The sender does not receive its packet");
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (models[i]->m_seen, 1, "Receiver " << i << " got the packet");
+      NS_TEST_EXPECT_MSG_EQ (models[i]->m_intact, 1, "Receiver " << i << " got the packet as it was sent");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_count, 3, "Each receiver forwarded its own modified copy");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 1000, "The packet of the sender is unchanged");
+  NS_TEST_EXPECT_MSG_EQ (packet->PeekPacketTag (tag), false, "The packet of the sender has no tag");
+}
+
 // This is the start of an error model test suite.  For starters, this is
 // just testing that the SimpleNetDevice is working but this can be
 // extended to many more test cases in the future
@@ -238,6 +352,7 @@ ErrorModelTestSuite::ErrorModelTestSuite ()
 {
   AddTestCase (new ErrorModelSimple, TestCase::QUICK);
   AddTestCase (new BurstErrorModelSimple, TestCase::QUICK);
+  AddTestCase (new ErrorModelSharedPacket, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
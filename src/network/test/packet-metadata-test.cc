@@ -17,6 +17,7 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
 #include <cstdarg>
 #include <iostream>
 #include <sstream>
@@ -256,6 +257,12 @@ public:
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  /**
+   * Constructor of the derived test cases.
+   * \param name The name of the test case.
+   */
+  PacketMetadataTest (std::string name);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
 };
@@ -265,6 +272,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -823,6 +835,65 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 //-----------------------------------------------------------------------------
+class PacketMetadataSamplingTest : public PacketMetadataTest
+{
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : PacketMetadataTest ("Packet metadata sampling")
+{
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  PacketMetadata::EnableSampling (2);
+
+  Ptr<Packet> sampled = Create<Packet> (10);
+  Ptr<Packet> skipped = Create<Packet> (10);
+  if (sampled->GetUid () % 2 != 0)
+    {
+      std::swap (sampled, skipped);
+    }
+  ADD_HEADER (sampled, 1);
+  ADD_HEADER (skipped, 1);
+  CHECK_HISTORY (sampled, 2, 1, 10);
+  CHECK_HISTORY (skipped, 0);
+
+  Ptr<Packet> copy = sampled->Copy ();
+  ADD_TRAILER (copy, 2);
+  CHECK_HISTORY (copy, 3, 1, 10, 2);
+  Ptr<Packet> fragment = copy->CreateFragment (1, 10);
+  CHECK_HISTORY (fragment, 1, 10);
+  REM_HEADER (sampled, 1);
+  CHECK_HISTORY (sampled, 1, 10);
+
+  // A packet out of the sample records nothing, even with sampled data
+  Ptr<Packet> skippedCopy = skipped->Copy ();
+  skippedCopy->AddAtEnd (sampled);
+  CHECK_HISTORY (skippedCopy, 0);
+  NS_TEST_EXPECT_MSG_EQ (skippedCopy->GetSize (), 21, "Skipped packets are still built");
+
+  // The unrecorded bytes of a skipped packet appended to a sampled one
+  // are accounted for as payload
+  sampled->AddAtEnd (skipped);
+  CHECK_HISTORY (sampled, 2, 10, 11);
+  NS_TEST_EXPECT_MSG_EQ (sampled->GetSize (), 21, "Sampled packet built");
+  ADD_TRAILER (sampled, 3);
+  CHECK_HISTORY (sampled, 3, 10, 11, 3);
+  REM_TRAILER (sampled, 3);
+  sampled->RemoveAtEnd (5);
+  CHECK_HISTORY (sampled, 2, 10, 6);
+
+  PacketMetadata::EnableSampling (1);
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  CHECK_HISTORY (p, 2, 1, 10);
+}
+//-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
 {
 public:
@@ -833,6 +904,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/packet-pool.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+#include "ns3/test.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+
+using namespace ns3;
+
+namespace {
+
+/** A packet tag of four bytes. */
+class PoolTestTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::PoolTestTag")
+      .SetParent<Tag> ()
+      .SetGroupName ("Network")
+      .AddConstructor<PoolTestTag> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (TagBuffer i) const
+  {
+    i.WriteU32 (0);
+  }
+  virtual void Deserialize (TagBuffer i)
+  {
+    i.ReadU32 ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+};
+
+} // unnamed namespace
+
+class PacketPoolAllocateTestCase : public TestCase
+{
+public:
+  PacketPoolAllocateTestCase ();
+  virtual void DoRun (void);
+};
+
+PacketPoolAllocateTestCase::PacketPoolAllocateTestCase ()
+  : TestCase ("Check that freed blocks are recycled by size class")
+{
+}
+
+void
+PacketPoolAllocateTestCase::DoRun (void)
+{
+  PacketPool::ResetStats ();
+  uint32_t size = 100;
+  void *a = PacketPool::Allocate (size);
+  NS_TEST_EXPECT_MSG_EQ (size, 128, "Sizes are rounded up to a power of two");
+  PacketPool::Deallocate (a, size);
+  size = 65;
+  void *b = PacketPool::Allocate (size);
+  NS_TEST_EXPECT_MSG_EQ (b, a, "Blocks of the same size class are recycled");
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetStats ().hits, 1, "Recycled block counted as a hit");
+  size = 1;
+  void *c = PacketPool::Allocate (size);
+  NS_TEST_EXPECT_MSG_EQ (size, PacketPool::MIN_SIZE, "Smallest size class");
+  NS_TEST_EXPECT_MSG_NE (c, b, "Distinct blocks");
+  PacketPool::Deallocate (c, 1);
+  PacketPool::Deallocate (b, 65);
+
+  PacketPool::ResetStats ();
+  size = PacketPool::MAX_SIZE + 1;
+  void *big = PacketPool::Allocate (size);
+  NS_TEST_EXPECT_MSG_EQ (size, PacketPool::MAX_SIZE + 1, "Large blocks are not rounded");
+  PacketPool::Deallocate (big, size);
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 1, "Large blocks are not pooled");
+  NS_TEST_EXPECT_MSG_EQ (stats.releases, 1, "Large blocks are freed");
+}
+
+class PacketPoolMaxFreeBytesTestCase : public TestCase
+{
+public:
+  PacketPoolMaxFreeBytesTestCase ();
+  virtual void DoRun (void);
+};
+
+PacketPoolMaxFreeBytesTestCase::PacketPoolMaxFreeBytesTestCase ()
+  : TestCase ("Check that the free lists are capped")
+{
+}
+
+void
+PacketPoolMaxFreeBytesTestCase::DoRun (void)
+{
+  uint32_t saved = PacketPool::GetMaxFreeBytes ();
+  // A size class which no other test case uses
+  uint32_t size = PacketPool::MAX_SIZE / 2;
+  void *blocks[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      blocks[i] = PacketPool::Allocate (size);
+    }
+  PacketPool::SetMaxFreeBytes (2 * size);
+  PacketPool::ResetStats ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      PacketPool::Deallocate (blocks[i], size);
+    }
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetStats ().releases, 2, "Blocks beyond the cap are freed");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      blocks[i] = PacketPool::Allocate (size);
+    }
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetStats ().hits, 2, "Blocks under the cap are kept");
+
+  PacketPool::SetMaxFreeBytes (0);
+  PacketPool::ResetStats ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      PacketPool::Deallocate (blocks[i], size);
+    }
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetStats ().releases, 4, "Zero disables the free lists");
+  PacketPool::SetMaxFreeBytes (saved);
+}
+
+class PacketPoolPacketTestCase : public TestCase
+{
+public:
+  PacketPoolPacketTestCase ();
+  virtual void DoRun (void);
+  /** Create and destroy packets of various sizes, with tags. */
+  void CreatePackets (void);
+};
+
+PacketPoolPacketTestCase::PacketPoolPacketTestCase ()
+  : TestCase ("Check that the storage of packets is taken from the pool")
+{
+}
+
+void
+PacketPoolPacketTestCase::CreatePackets (void)
+{
+  static const uint32_t sizes[] = { 0, 64, 1500, 100, 9000, 536 };
+  for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      Ptr<Packet> p = Create<Packet> (sizes[i]);
+      PoolTestTag tag;
+      p->AddPacketTag (tag);
+      p->AddByteTag (tag);
+      Ptr<Packet> fragment = p->CreateFragment (0, sizes[i] / 2);
+      fragment->AddAtEnd (Create<Packet> (sizes[i] / 4));
+    }
+}
+
+void
+PacketPoolPacketTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  CreatePackets ();
+  PacketPool::ResetStats ();
+  CreatePackets ();
+  PacketPool::Stats stats = PacketPool::GetStats ();
+  NS_TEST_EXPECT_MSG_GT (stats.hits, 0, "Packets are allocated from the pool");
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 0, "Packets reuse the storage of freed packets");
+}
+
+#ifdef HAVE_PTHREAD_H
+class PacketPoolThreadTestCase : public TestCase
+{
+public:
+  PacketPoolThreadTestCase ();
+  virtual void DoRun (void);
+  void Allocate (void);
+  PacketPool::Stats m_stats;
+};
+
+PacketPoolThreadTestCase::PacketPoolThreadTestCase ()
+  : TestCase ("Check that each thread has its own pool")
+{
+}
+
+void
+PacketPoolThreadTestCase::Allocate (void)
+{
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      uint32_t size = 256;
+      PacketPool::Deallocate (PacketPool::Allocate (size), size);
+    }
+  m_stats = PacketPool::GetStats ();
+}
+
+void
+PacketPoolThreadTestCase::DoRun (void)
+{
+  PacketPool::ResetStats ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&PacketPoolThreadTestCase::Allocate, this));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (m_stats.misses, 1, "A new thread starts with empty free lists");
+  NS_TEST_EXPECT_MSG_EQ (m_stats.hits, 9, "The thread recycles its own blocks");
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetStats ().hits + PacketPool::GetStats ().misses, 0,
+                         "Counters are per thread");
+}
+#endif /* HAVE_PTHREAD_H */
+
+class PacketPoolTestSuite : public TestSuite
+{
+public:
+  PacketPoolTestSuite ()
+    : TestSuite ("packet-pool", UNIT)
+  {
+    AddTestCase (new PacketPoolAllocateTestCase (), TestCase::QUICK);
+    AddTestCase (new PacketPoolMaxFreeBytesTestCase (), TestCase::QUICK);
+    AddTestCase (new PacketPoolPacketTestCase (), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new PacketPoolThreadTestCase (), TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
+  }
+} g_packetPoolTestSuite;
@@ -19,14 +19,19 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/llc-snap-header.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include "ns3/simulator.h"
+#include "ns3/system-thread.h"
+#include "ns3/core-config.h"
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <set>
 
 using namespace ns3;
 
@@ -582,6 +587,29 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test ReplaceHeader on a shared and on a private buffer. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    LlcSnapHeader llc;
+    llc.SetType (0x0800);
+    tmp->AddHeader (llc);
+    tmp->AddByteTag (ATestTag<25> ());
+    Ptr<Packet> copy = tmp->Copy ();
+    llc.SetType (0x0806);
+    copy->ReplaceHeader (llc);
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 108, "Size is unchanged");
+    CHECK (copy, 1, E (25, 0, 108));
+    LlcSnapHeader read;
+    copy->PeekHeader (read);
+    NS_TEST_EXPECT_MSG_EQ (read.GetType (), 0x0806, "Header is overwritten");
+    tmp->PeekHeader (read);
+    NS_TEST_EXPECT_MSG_EQ (read.GetType (), 0x0800, "Shared copy is not modified");
+    llc.SetType (0x86dd);
+    copy->ReplaceHeader (llc);
+    copy->RemoveHeader (read);
+    NS_TEST_EXPECT_MSG_EQ (read.GetType (), 0x86dd, "Private buffer is overwritten");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -847,6 +875,62 @@ PacketTagListTest::DoRun (void)
     
 }
 
+#ifdef HAVE_PTHREAD_H
+//-----------------------------------------------------------------------------
+class PacketUidThreadsTest : public TestCase
+{
+public:
+  PacketUidThreadsTest ();
+  virtual void DoRun (void);
+  /**
+   * Create packets and record their uids.
+   * \param [in] thread The index of the calling thread.
+   */
+  static void Create (uint32_t thread);
+  static const uint32_t THREADS = 4;
+  static const uint32_t PACKETS = 20000;
+  static std::vector<uint64_t> m_uids[THREADS]; //!< Uids created by each thread
+};
+
+std::vector<uint64_t> PacketUidThreadsTest::m_uids[PacketUidThreadsTest::THREADS];
+
+PacketUidThreadsTest::PacketUidThreadsTest ()
+  : TestCase ("Check that packets created by several threads get distinct uids")
+{
+}
+
+void
+PacketUidThreadsTest::Create (uint32_t thread)
+{
+  for (uint32_t i = 0; i < PACKETS; i++)
+    {
+      m_uids[thread].push_back (ns3::Create<Packet> (10)->GetUid ());
+    }
+}
+
+void
+PacketUidThreadsTest::DoRun (void)
+{
+  // Create the simulator implementation before the threads use it
+  Simulator::GetSystemId ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < THREADS; t++)
+    {
+      threads.push_back (ns3::Create<SystemThread> (MakeBoundCallback (&PacketUidThreadsTest::Create, t)));
+      threads.back ()->Start ();
+    }
+  std::set<uint64_t> uids;
+  for (uint32_t t = 0; t < THREADS; t++)
+    {
+      threads[t]->Join ();
+      uids.insert (m_uids[t].begin (), m_uids[t].end ());
+      m_uids[t].clear ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (uids.size (), THREADS * PACKETS, "Duplicate packet uids");
+  Simulator::Destroy ();
+}
+#endif /* HAVE_PTHREAD_H */
+
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -859,6 +943,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new PacketUidThreadsTest, TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -0,0 +1,466 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-trace-writer.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/core-config.h"
+#include <algorithm>
+#include <cstring>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <unistd.h>
+#endif /* HAVE_PTHREAD_H */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncTraceWriter");
+
+/**
+ * \brief The size of each of the two buffers shared by the trace files.
+ */
+static GlobalValue g_asyncTraceBufferSize = GlobalValue ("AsyncTraceBufferSize",
+                                                         "The size of each of the two buffers of the background writer "
+                                                         "of the trace files; 0 writes the files synchronously",
+                                                         UintegerValue (0),
+                                                         MakeUintegerChecker<uint32_t> ());
+
+namespace {
+
+/** Size of the buffer of each stream. */
+const uint32_t LOCAL_SIZE = 4096;
+
+/** Bytes of a buffer to write to a file. */
+struct Chunk
+{
+  std::streambuf *target; /**< The stream buffer of the file. */
+  uint32_t size;          /**< The number of bytes. */
+};
+
+/** A buffer shared by all the files. */
+struct Batch
+{
+  std::vector<char> data;    /**< The bytes. */
+  std::vector<Chunk> chunks; /**< The files of the bytes, in order. */
+};
+
+/**
+ * Write a batch to its files, and empty it.
+ *
+ * The files are synchronized, so that nothing written is left in their
+ * buffers for a fork to duplicate or a fatal error to lose.
+ *
+ * \param [in,out] batch The batch.
+ */
+void
+WriteBatch (Batch *batch)
+{
+  const char *data = batch->data.empty () ? 0 : &batch->data[0];
+  for (std::vector<Chunk>::const_iterator i = batch->chunks.begin (); i != batch->chunks.end (); ++i)
+    {
+      i->target->sputn (data, i->size);
+      i->target->pubsync ();
+      data += i->size;
+    }
+  batch->data.clear ();
+  batch->chunks.clear ();
+}
+
+/** The double buffer, and the thread which writes it. */
+class Writer
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] size The size of each buffer.
+   */
+  Writer (uint32_t size);
+  /**
+   * Append bytes to the current buffer.
+   * \param [in] target The stream buffer of the file.
+   * \param [in] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void Append (std::streambuf *target, const char *data, uint32_t size);
+  /** Write all the bytes appended so far, and wait for them. */
+  void Flush (void);
+  /**
+   * Write all the bytes appended so far from the calling thread, on the
+   * fatal error path.  Never blocks: gives up after about a second if
+   * the lock stays taken or the thread does not finish its buffer.
+   */
+  void FlushFatal (void);
+
+private:
+  /** Write all the bytes of the writer, registered with FatalImpl::RegisterFlushHook. */
+  static void FlushHook (void);
+#ifdef HAVE_PTHREAD_H
+  /** Swap the buffers, once the thread has written the previous one. */
+  void SwapLocked (void);
+  /** Start the thread. */
+  void StartThread (void);
+  /** Write all the buffers and keep the lock across a fork. */
+  static void PrepareFork (void);
+  /** Release the lock in the parent process after a fork. */
+  static void ParentFork (void);
+  /**
+   * Release the lock and restart the thread, which a fork does not copy,
+   * in the child process.
+   */
+  static void ChildFork (void);
+  /**
+   * Body of the thread.
+   * \param [in] writer The Writer.
+   * \returns Never.
+   */
+  static void * Run (void *writer);
+
+  pthread_mutex_t m_mutex; //!< Protects the buffers.
+  pthread_cond_t m_cond;   //!< Signals a change of m_pending.
+  pthread_t m_thread;      //!< The thread.
+  bool m_pending;          //!< Whether m_back is to be written.
+#endif /* HAVE_PTHREAD_H */
+  Batch m_batches[2];      //!< The two buffers.
+  Batch *m_front;          //!< The buffer filled by the simulation.
+  Batch *m_back;           //!< The buffer written by the thread.
+  uint32_t m_size;         //!< The size of each buffer.
+};
+
+/**
+ * Get the writer, created on first use.
+ *
+ * It is never destroyed: the trace files may be closed by static
+ * destructors.
+ *
+ * \returns The writer.
+ */
+Writer *
+GetWriter (void)
+{
+  static Writer *writer = new Writer (AsyncTraceWriter::GetBufferSize ());
+  return writer;
+}
+
+Writer::Writer (uint32_t size)
+  : m_front (&m_batches[0]),
+    m_back (&m_batches[1]),
+    m_size (size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_front->data.reserve (size);
+  m_back->data.reserve (size);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init (&m_mutex, 0);
+  pthread_cond_init (&m_cond, 0);
+  m_pending = false;
+  StartThread ();
+  pthread_atfork (&Writer::PrepareFork, &Writer::ParentFork, &Writer::ChildFork);
+#endif /* HAVE_PTHREAD_H */
+  FatalImpl::RegisterFlushHook (&Writer::FlushHook);
+}
+
+void
+Writer::FlushHook (void)
+{
+  GetWriter ()->FlushFatal ();
+}
+
+#ifdef HAVE_PTHREAD_H
+
+void
+Writer::StartThread (void)
+{
+  pthread_create (&m_thread, 0, &Writer::Run, this);
+  pthread_detach (m_thread);
+}
+
+void
+Writer::Append (std::streambuf *target, const char *data, uint32_t size)
+{
+  bool fatal = FatalImpl::IsFlushingStreams ();
+  if (fatal)
+    {
+      // The stream is flushed on the fatal error path, where the lock may
+      // be held by the failing thread: the front buffer grows instead of
+      // waiting for the thread, and FlushFatal writes it
+      if (pthread_mutex_trylock (&m_mutex) != 0)
+        {
+          return;
+        }
+    }
+  else
+    {
+      pthread_mutex_lock (&m_mutex);
+    }
+  if (!fatal && !m_front->data.empty () && m_front->data.size () + size > m_size)
+    {
+      SwapLocked ();
+    }
+  m_front->data.insert (m_front->data.end (), data, data + size);
+  if (!m_front->chunks.empty () && m_front->chunks.back ().target == target)
+    {
+      m_front->chunks.back ().size += size;
+    }
+  else
+    {
+      Chunk chunk = { target, size };
+      m_front->chunks.push_back (chunk);
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+void
+Writer::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  pthread_mutex_lock (&m_mutex);
+  if (!m_front->chunks.empty ())
+    {
+      SwapLocked ();
+    }
+  while (m_pending)
+    {
+      pthread_cond_wait (&m_cond, &m_mutex);
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+void
+Writer::FlushFatal (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The lock may be held by a thread which will never run again, and the
+  // background thread may be the failing one: poll for about a second,
+  // without blocking, until the back buffer is written
+  for (uint32_t tries = 0; tries < 1000; tries++)
+    {
+      if (pthread_mutex_trylock (&m_mutex) == 0)
+        {
+          if (!m_pending)
+            {
+              WriteBatch (m_front);
+              pthread_mutex_unlock (&m_mutex);
+              return;
+            }
+          pthread_mutex_unlock (&m_mutex);
+        }
+      usleep (1000);
+    }
+}
+
+void
+Writer::PrepareFork (void)
+{
+  Writer *writer = GetWriter ();
+  pthread_mutex_lock (&writer->m_mutex);
+  if (!writer->m_front->chunks.empty ())
+    {
+      writer->SwapLocked ();
+    }
+  while (writer->m_pending)
+    {
+      pthread_cond_wait (&writer->m_cond, &writer->m_mutex);
+    }
+}
+
+void
+Writer::ParentFork (void)
+{
+  pthread_mutex_unlock (&GetWriter ()->m_mutex);
+}
+
+void
+Writer::ChildFork (void)
+{
+  // The child runs the forking thread, which holds the lock.  The
+  // condition may still count the waits of the parent's background
+  // thread, which does not exist here: start from a new one.
+  Writer *writer = GetWriter ();
+  pthread_mutex_unlock (&writer->m_mutex);
+  pthread_cond_init (&writer->m_cond, 0);
+  writer->m_pending = false;
+  writer->m_front->data.clear ();
+  writer->m_front->chunks.clear ();
+  writer->m_back->data.clear ();
+  writer->m_back->chunks.clear ();
+  writer->StartThread ();
+}
+
+void
+Writer::SwapLocked (void)
+{
+  while (m_pending)
+    {
+      pthread_cond_wait (&m_cond, &m_mutex);
+    }
+  std::swap (m_front, m_back);
+  m_pending = true;
+  pthread_cond_broadcast (&m_cond);
+}
+
+void *
+Writer::Run (void *arg)
+{
+  Writer *writer = static_cast<Writer *> (arg);
+  pthread_mutex_lock (&writer->m_mutex);
+  while (true)
+    {
+      while (!writer->m_pending)
+        {
+          pthread_cond_wait (&writer->m_cond, &writer->m_mutex);
+        }
+      // m_back is not touched by the simulation while m_pending is set
+      pthread_mutex_unlock (&writer->m_mutex);
+      WriteBatch (writer->m_back);
+      pthread_mutex_lock (&writer->m_mutex);
+      writer->m_pending = false;
+      pthread_cond_broadcast (&writer->m_cond);
+    }
+  return 0;
+}
+
+#else /* HAVE_PTHREAD_H */
+
+void
+Writer::Append (std::streambuf *target, const char *data, uint32_t size)
+{
+  if (!m_front->data.empty () && m_front->data.size () + size > m_size)
+    {
+      WriteBatch (m_front);
+    }
+  m_front->data.insert (m_front->data.end (), data, data + size);
+  Chunk chunk = { target, size };
+  m_front->chunks.push_back (chunk);
+}
+
+void
+Writer::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteBatch (m_front);
+}
+
+void
+Writer::FlushFatal (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteBatch (m_front);
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+} // unnamed namespace
+
+AsyncTraceWriter::AsyncTraceWriter (std::streambuf *target)
+  : m_target (target),
+    m_local (LOCAL_SIZE)
+{
+  NS_LOG_FUNCTION (this << target);
+  setp (&m_local[0], &m_local[0] + m_local.size ());
+  GetWriter ();
+}
+
+AsyncTraceWriter::~AsyncTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Drain ();
+}
+
+void
+AsyncTraceWriter::Drain (void)
+{
+  NS_LOG_FUNCTION (this);
+  Submit ();
+  GetWriter ()->Flush ();
+  m_target->pubsync ();
+}
+
+uint32_t
+AsyncTraceWriter::GetBufferSize (void)
+{
+  UintegerValue size;
+  g_asyncTraceBufferSize.GetValue (size);
+  return size.Get ();
+}
+
+void
+AsyncTraceWriter::Submit (void)
+{
+  uint32_t size = pptr () - pbase ();
+  if (size > 0)
+    {
+      GetWriter ()->Append (m_target, pbase (), size);
+      setp (&m_local[0], &m_local[0] + m_local.size ());
+    }
+}
+
+AsyncTraceWriter::int_type
+AsyncTraceWriter::overflow (int_type c)
+{
+  Submit ();
+  if (traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      return traits_type::not_eof (c);
+    }
+  *pptr () = traits_type::to_char_type (c);
+  pbump (1);
+  return c;
+}
+
+std::streamsize
+AsyncTraceWriter::xsputn (const char *s, std::streamsize n)
+{
+  if (n > epptr () - pptr ())
+    {
+      Submit ();
+      if (n >= static_cast<std::streamsize> (m_local.size ()))
+        {
+          GetWriter ()->Append (m_target, s, n);
+          return n;
+        }
+    }
+  std::memcpy (pptr (), s, n);
+  pbump (n);
+  return n;
+}
+
+int
+AsyncTraceWriter::sync (void)
+{
+  Submit ();
+  return 0;
+}
+
+AsyncTraceWriter::pos_type
+AsyncTraceWriter::seekoff (off_type off, std::ios_base::seekdir dir,
+                           std::ios_base::openmode which)
+{
+  NS_LOG_FUNCTION (this << off << dir);
+  Drain ();
+  return m_target->pubseekoff (off, dir, which);
+}
+
+AsyncTraceWriter::pos_type
+AsyncTraceWriter::seekpos (pos_type pos, std::ios_base::openmode which)
+{
+  NS_LOG_FUNCTION (this << pos);
+  Drain ();
+  return m_target->pubseekpos (pos, which);
+}
+
+} // namespace ns3
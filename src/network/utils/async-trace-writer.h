@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_TRACE_WRITER_H
+#define ASYNC_TRACE_WRITER_H
+
+#include <streambuf>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::AsyncTraceWriter declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief A stream buffer which writes a trace file from a background thread.
+ *
+ * The bytes written to the stream are gathered in a small buffer of the
+ * stream, then appended to a large buffer shared by all the trace files.
+ * When the shared buffer is full, it is swapped with a second one, and
+ * a background thread writes the full buffer to the files while the
+ * simulation fills the other.  The simulation waits only if the
+ * background thread has not finished writing the previous buffer.
+ *
+ * PcapFile and the OutputStreamWrapper of a file, hence the pcap and
+ * ASCII traces of the helpers, use this stream buffer when the global
+ * value "AsyncTraceBufferSize", the size of each of the two shared
+ * buffers, is not zero.  It must be set before the trace files are
+ * opened, for example with --AsyncTraceBufferSize=4194304 on the command
+ * line.
+ *
+ * The file is complete once the stream buffer is drained, which happens
+ * when the PcapFile or OutputStreamWrapper is closed or destroyed.
+ * Flushing the stream (std::endl or std::flush) only hands its bytes to
+ * the shared buffer.  Write errors are not reported to the stream.
+ * On NS_FATAL_ERROR, the thread reporting the error writes the shared
+ * buffers itself, through FatalImpl::RegisterFlushHook.  A fork, such as
+ * Checkpoint::Fork, first waits until all the buffers are written, then
+ * starts a new background thread in the child process.
+ *
+ * Without pthreads, the shared buffer is written by the simulation thread
+ * when it is full.
+ */
+class AsyncTraceWriter : public std::streambuf
+{
+public:
+  /**
+   * Create a stream buffer which writes to \p target.
+   *
+   * \param [in] target The stream buffer of the file, which must outlive
+   *        this stream buffer.
+   */
+  AsyncTraceWriter (std::streambuf *target);
+  /** Drain the stream buffer. */
+  virtual ~AsyncTraceWriter ();
+
+  /**
+   * Write all the bytes written so far to the target stream buffer, and
+   * wait until they are written.
+   */
+  void Drain (void);
+
+  /**
+   * \returns The size of each of the two shared buffers, from the global
+   *          value "AsyncTraceBufferSize"; zero if disabled.
+   */
+  static uint32_t GetBufferSize (void);
+
+protected:
+  /**
+   * Hand the bytes to the shared buffer, and store one byte.
+   * \param [in] c The byte to store.
+   * \returns \p c, or a value other than eof if \p c is eof.
+   */
+  virtual int_type overflow (int_type c);
+  /**
+   * Store a sequence of bytes.
+   * \param [in] s The bytes.
+   * \param [in] n The number of bytes.
+   * \returns \p n.
+   */
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  /**
+   * Hand the bytes to the shared buffer.
+   * \returns 0.
+   */
+  virtual int sync (void);
+  /**
+   * Drain the stream buffer, and move the position of the target.
+   * \param [in] off The offset.
+   * \param [in] dir The origin of the offset.
+   * \param [in] which The positions to move.
+   * \returns The new position.
+   */
+  virtual pos_type seekoff (off_type off, std::ios_base::seekdir dir,
+                            std::ios_base::openmode which);
+  /**
+   * Drain the stream buffer, and move the position of the target.
+   * \param [in] pos The new position.
+   * \param [in] which The positions to move.
+   * \returns The new position.
+   */
+  virtual pos_type seekpos (pos_type pos, std::ios_base::openmode which);
+
+private:
+  /** Hand the bytes of the local buffer to the shared buffer. */
+  void Submit (void);
+
+  std::streambuf *m_target;   //!< The stream buffer of the file.
+  std::vector<char> m_local;  //!< The local buffer.
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_WRITER_H */
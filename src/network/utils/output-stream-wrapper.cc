@@ -17,6 +17,7 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "async-trace-writer.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
@@ -27,7 +28,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_destroyable (true),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
   std::ofstream* os = new std::ofstream ();
@@ -36,10 +38,15 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (os->is_open (), "AsciiTraceHelper::CreateFileStream():  " <<
                        "Unable to Open " << filename << " for mode " << filemode);
+  if (AsyncTraceWriter::GetBufferSize () > 0)
+    {
+      m_writer = new AsyncTraceWriter (os->rdbuf ());
+      m_ostream->rdbuf (m_writer);
+    }
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_destroyable (false), m_writer (0)
 {
   NS_LOG_FUNCTION (this << os);
   FatalImpl::RegisterStream (m_ostream);
@@ -50,6 +57,12 @@ OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::UnregisterStream (m_ostream);
+  if (m_writer != 0)
+    {
+      m_writer->Drain ();
+      m_ostream->rdbuf (static_cast<std::ofstream *> (m_ostream)->rdbuf ());
+      delete m_writer;
+    }
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
 }
@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class AsyncTraceWriter;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -64,6 +66,10 @@ namespace ns3 {
  * \endverbatim
  *
  *
+ * A file opened by the wrapper is written by an AsyncTraceWriter when
+ * the global value "AsyncTraceBufferSize" is not zero: it is complete
+ * once the wrapper is destroyed.
+ *
  * This class uses a basic ns-3 reference counting base class but is not 
  * an ns3::Object with attributes, TypeId, or aggregation.
  */
@@ -95,6 +101,7 @@ public:
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  AsyncTraceWriter *m_writer; //!< Background writer of the file, or null
 };
 
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "async-trace-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -49,6 +50,7 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 
 PcapFile::PcapFile ()
   : m_file (),
+    m_writer (0),
     m_swapMode (false),
     m_nanosecMode (false)
 {
@@ -88,6 +90,13 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Drain ();
+      static_cast<std::ios &> (m_file).rdbuf (m_file.rdbuf ());
+      delete m_writer;
+      m_writer = 0;
+    }
   m_file.close ();
 }
 
@@ -339,6 +348,11 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
       // will set the fail bit if file header is invalid.
       ReadAndVerifyFileHeader ();
     }
+  else if (m_file.is_open () && AsyncTraceWriter::GetBufferSize () > 0)
+    {
+      m_writer = new AsyncTraceWriter (m_file.rdbuf ());
+      static_cast<std::ios &> (m_file).rdbuf (m_writer);
+    }
 }
 
 void
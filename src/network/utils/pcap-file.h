@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncTraceWriter;
 
 
 /**
@@ -38,6 +39,10 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and 
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * A file opened for writing only is written by an AsyncTraceWriter
+ * when the global value "AsyncTraceBufferSize" is not zero: it is
+ * complete once closed.
  */
 class PcapFile
 {
@@ -368,6 +373,7 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  AsyncTraceWriter *m_writer;   //!< background writer of m_file, or null
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
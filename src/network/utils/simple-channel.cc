@@ -57,6 +57,9 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
                      Ptr<SimpleNetDevice> sender)
 {
   NS_LOG_FUNCTION (this << p << protocol << to << from << sender);
+  // All the devices receive the packet of the sender, which it no longer
+  // modifies: they copy it only if they forward it
+  Ptr<const Packet> packet = p;
   for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
     {
       Ptr<SimpleNetDevice> tmp = *i;
@@ -73,7 +76,7 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
             }
         }
       Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
-                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                      &SimpleNetDevice::Receive, tmp, packet, protocol, to, from);
     }
 }
 
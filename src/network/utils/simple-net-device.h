@@ -67,12 +67,16 @@ public:
    * SimpleNetDevice receives packets from its connected channel
    * and then forwards them by calling its rx callback method
    *
+   * The packet may be shared by all the devices of the channel, so
+   * the device copies it before forwarding it, and only if it is
+   * forwarded.
+   *
    * \param packet Packet received on the channel
    * \param protocol protocol number
    * \param to address packet should be sent to
    * \param from address packet was sent from
    */
-  void Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
+  void Receive (Ptr<const Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
   
   /**
    * Attach a channel to this net device.  This will be the 
@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -94,6 +95,22 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (m_next != 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return DoGetMaxRange (txPowerDbm, rxPowerDbm);
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -924,6 +941,16 @@ RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const
+{
+  if (rxPowerDbm >= -1000)
+    {
+      return m_range;
+    }
+  return std::numeric_limits<double>::infinity ();
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams (int64_t stream)
 {
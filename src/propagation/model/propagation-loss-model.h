@@ -106,6 +106,21 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns a distance beyond which the Rx power computed by this model
+   * is at most \p rxPowerDbm, whatever the random variables draw.
+   * Channels can use it to avoid computing the Rx power of the receivers
+   * which are too far to be affected by a transmission.
+   *
+   * The distance is infinite if this model does not provide it, or if
+   * other models are chained to it.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param rxPowerDbm the Rx power (in dBm)
+   * \returns the distance (in meters), or infinity
+   */
+  double GetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -134,6 +149,17 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const = 0;
 
+  /**
+   * Returns a distance beyond which the Rx power computed by this
+   * particular PropagationLossModel is at most \p rxPowerDbm.
+   * The default implementation returns infinity.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param rxPowerDbm the Rx power (in dBm)
+   * \returns the distance (in meters), or infinity
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
+
   /**
    * Subclasses must implement this; those not using random variables
    * can return zero
@@ -851,6 +877,7 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual double DoGetMaxRange (double txPowerDbm, double rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 private:
   double m_range; //!< Maximum Transmission Range (meters)
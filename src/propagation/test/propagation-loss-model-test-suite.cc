@@ -25,6 +25,8 @@
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
+#include <limits>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PropagationLossModelsTest");
@@ -433,6 +435,13 @@ RangePropagationLossModelTestCase::DoRun (void)
   b->SetPosition (Vector (127.25,0,0));  // beyond range
   resultdBm = lossModel->CalcRxPower (txPwrdBm, a, b);
   NS_TEST_EXPECT_MSG_EQ_TOL (resultdBm, -1000.0, tolerance, "Got unexpected rcv power");
+
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetMaxRange (txPwrdBm, -96.0), 127.2, "Got unexpected max range");
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetMaxRange (txPwrdBm, -1001.0), std::numeric_limits<double>::infinity (),
+                         "Rx power below the power beyond range");
+  lossModel->SetNext (CreateObject<FriisPropagationLossModel> ());
+  NS_TEST_EXPECT_MSG_EQ (lossModel->GetMaxRange (txPwrdBm, -96.0), std::numeric_limits<double>::infinity (),
+                         "Chained models have no max range");
   Simulator::Destroy ();
 }
 
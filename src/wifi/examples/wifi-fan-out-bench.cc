@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Benchmark of the heap allocations made to deliver a wifi broadcast.
+ *
+ * The adhoc nodes stand on a grid 30 m apart, all in range of each other
+ * with the default channel.  They broadcast frames in turn, 5 ms apart.
+ * The program counts the calls to operator new made while the simulation
+ * runs, and prints their number per frame.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+using namespace ns3;
+
+namespace {
+
+/** Number of calls to operator new. */
+uint64_t g_allocations;
+
+/** Broadcast a frame of 100 bytes. */
+void
+Send (Ptr<NetDevice> device)
+{
+  device->Send (Create<Packet> (100), device->GetBroadcast (), 0x800);
+}
+
+} // unnamed namespace
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 50;
+  uint32_t frames = 2000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("frames", "Number of frames sent", frames);
+  cmd.Parse (argc, argv);
+
+  NodeContainer adhoc;
+  adhoc.Create (nodes);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, adhoc);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (30),
+                                 "DeltaY", DoubleValue (30),
+                                 "GridWidth", UintegerValue (10));
+  mobility.Install (adhoc);
+
+  for (uint32_t i = 0; i < frames; i++)
+    {
+      Simulator::Schedule (MilliSeconds (5 * i), &Send, devices.Get (i % nodes));
+    }
+
+  uint64_t start = g_allocations;
+  Simulator::Run ();
+  std::cout << "allocations per frame " << (g_allocations - start) / double (frames) << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
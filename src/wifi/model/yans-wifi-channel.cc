@@ -25,10 +25,14 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -51,11 +55,20 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverGridCellSize",
+                   "The size (m) of the cells of the grid indexing the positions of the PHYs, "
+                   "which lets a transmission visit only the PHYs within the maximum range of "
+                   "the propagation loss model.  Zero disables the grid.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cellSize),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_cellSize (0.0),
+    m_gridEdThresholdDbm (std::numeric_limits<double>::infinity ())
 {
 }
 
@@ -65,6 +78,24 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_gridMobility.size (); i++)
+    {
+      m_gridMobility[i]->TraceDisconnectWithoutContext ("CourseChange",
+                                                        MakeBoundCallback (&YansWifiChannel::CourseChanged,
+                                                                           (const YansWifiChannel *) this, i));
+    }
+  m_gridMobility.clear ();
+  m_gridCell.clear ();
+  m_gridMoving.clear ();
+  m_grid.clear ();
+  m_moving.clear ();
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -83,50 +114,179 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  // The sender may modify its packet later: all the receivers share a copy
+  Ptr<const Packet> copy = packet->Copy ();
+
+  struct Parameters parameters;
+  parameters.type = mpdutype;
+  parameters.duration = duration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+
+  if (m_cellSize > 0)
     {
-      if (sender != (*i))
+      UpdateGrid ();
+      double range = m_loss->GetMaxRange (txPowerDbm, m_gridEdThresholdDbm);
+      if (range != std::numeric_limits<double>::infinity ())
         {
-          //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          std::vector<uint32_t> phys;
+          GetPhysInRange (senderMobility->GetPosition (), range, phys);
+          NS_LOG_DEBUG ("visit " << phys.size () << " of " << m_phyList.size () << " PHYs within " << range << "m");
+          for (std::vector<uint32_t>::const_iterator j = phys.begin (); j != phys.end (); j++)
             {
-              continue;
+              ScheduleReceive (*j, sender, senderMobility, copy, txPowerDbm, parameters);
             }
+          return;
+        }
+    }
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      ScheduleReceive (j, sender, senderMobility, copy, txPowerDbm, parameters);
+    }
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+void
+YansWifiChannel::ScheduleReceive (uint32_t j, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                                  Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters) const
+{
+  if (sender == m_phyList[j])
+    {
+      return;
+    }
+  //For now don't account for inter channel interference
+  if (m_phyList[j]->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  parameters.rxPowerDbm = rxPowerDbm;
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  j, packet, parameters);
+}
+
+void
+YansWifiChannel::UpdateGrid (void) const
+{
+  for (uint32_t i = m_gridMobility.size (); i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      m_gridMobility.push_back (mobility);
+      m_gridCell.push_back (Cell (0, 0));
+      m_gridMoving.push_back (false);
+      m_gridEdThresholdDbm = std::min (m_gridEdThresholdDbm, m_phyList[i]->GetEdThreshold ());
+      AddToGrid (i, mobility);
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeBoundCallback (&YansWifiChannel::CourseChanged, this, i));
+    }
+}
+
+YansWifiChannel::Cell
+YansWifiChannel::GetCell (const Vector &position) const
+{
+  return Cell (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+               static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+YansWifiChannel::AddToGrid (uint32_t i, Ptr<const MobilityModel> mobility) const
+{
+  Vector velocity = mobility->GetVelocity ();
+  m_gridMoving[i] = velocity.x != 0 || velocity.y != 0 || velocity.z != 0;
+  if (m_gridMoving[i])
+    {
+      m_moving.push_back (i);
+    }
+  else
+    {
+      m_gridCell[i] = GetCell (mobility->GetPosition ());
+      m_grid[m_gridCell[i]].push_back (i);
+    }
+}
+
+void
+YansWifiChannel::RemoveFromGrid (uint32_t i) const
+{
+  if (m_gridMoving[i])
+    {
+      m_moving.erase (std::find (m_moving.begin (), m_moving.end (), i));
+    }
+  else
+    {
+      Grid::iterator cell = m_grid.find (m_gridCell[i]);
+      cell->second.erase (std::find (cell->second.begin (), cell->second.end (), i));
+      if (cell->second.empty ())
+        {
+          m_grid.erase (cell);
+        }
+    }
+}
+
+void
+YansWifiChannel::CourseChanged (const YansWifiChannel *channel, uint32_t i, Ptr<const MobilityModel> mobility)
+{
+  channel->RemoveFromGrid (i);
+  channel->AddToGrid (i, mobility);
+}
+
+void
+YansWifiChannel::GetPhysInRange (const Vector &position, double range, std::vector<uint32_t> &phys) const
+{
+  // Cover the rounding errors of the distance computed by the loss model
+  range += 1e-9 * range + 1e-6;
+  Cell min = GetCell (Vector (position.x - range, position.y - range, 0));
+  Cell max = GetCell (Vector (position.x + range, position.y + range, 0));
+  phys = m_moving;
+  double cells = (double)(max.first - min.first + 1) * (max.second - min.second + 1);
+  if (cells < m_grid.size ())
+    {
+      for (int64_t x = min.first; x <= max.first; x++)
+        {
+          for (int64_t y = min.second; y <= max.second; y++)
             {
-              dstNode = 0xffffffff;
+              Grid::const_iterator cell = m_grid.find (Cell (x, y));
+              if (cell != m_grid.end ())
+                {
+                  phys.insert (phys.end (), cell->second.begin (), cell->second.end ());
+                }
             }
-          else
+        }
+    }
+  else
+    {
+      for (Grid::const_iterator cell = m_grid.begin (); cell != m_grid.end (); cell++)
+        {
+          if (cell->first.first >= min.first && cell->first.first <= max.first
+              && cell->first.second >= min.second && cell->first.second <= max.second)
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              phys.insert (phys.end (), cell->second.begin (), cell->second.end ());
             }
-
-          struct Parameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
         }
     }
+  // Keep the order of the events of a visit of all the PHYs
+  std::sort (phys.begin (), phys.end ());
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const
 {
   m_phyList[i]->StartReceivePreambleAndHeader (packet, parameters.rxPowerDbm, parameters.txVector, parameters.preamble, parameters.type, parameters.duration);
 }
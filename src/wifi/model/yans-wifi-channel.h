@@ -22,6 +22,7 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
 #include "wifi-channel.h"
@@ -30,10 +31,12 @@
 #include "wifi-tx-vector.h"
 #include "yans-wifi-phy.h"
 #include "ns3/nstime.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 
@@ -57,6 +60,25 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * By default, each transmission visits all the PHYs of the channel.  When
+ * the ReceiverGridCellSize attribute is set, the positions of the PHYs
+ * are indexed in a grid of square cells and a transmission visits only
+ * the PHYs within the maximum range given by the propagation loss model
+ * (see PropagationLossModel::GetMaxRange) for the lowest energy
+ * detection threshold of the PHYs.  The PHYs beyond that range do not
+ * see the transmission at all: it is not added to their interference
+ * and does not fire their PhyRxDrop trace.  With a loss model such as
+ * ns3::RangePropagationLossModel, which receives the transmissions beyond
+ * its range at a negligible power, the receptions are the same as with
+ * a visit of all the PHYs.
+ *
+ * The grid follows the PHYs through the CourseChange trace of their
+ * mobility model: the PHYs which are moving, according to the velocity
+ * of their mobility model, are visited by all the transmissions.  The
+ * index must not be used with a random propagation delay model, whose
+ * draws depend on the PHYs visited.  The energy detection threshold of
+ * a PHY is read when it is indexed, at its first transmission.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -132,11 +154,79 @@ private:
    * \param txVector the TXVECTOR of the packet
    * \param preamble the type of preamble being used to send the packet
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
+  void Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const;
+
+  /**
+   * Schedule the reception of a packet by a YansWifiPhy.
+   *
+   * \param i index of the receiving YansWifiPhy in the PHY list
+   * \param sender the sending YansWifiPhy
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet being sent, shared by all the receivers
+   * \param txPowerDbm the tx power associated to the packet
+   * \param parameters the parameters of the transmission, of which the
+   *        received power is set by this method
+   */
+  void ScheduleReceive (uint32_t i, Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                        Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters) const;
+
+  virtual void DoDispose (void);
+
+  /// A cell of the receiver grid
+  typedef std::pair<int64_t, int64_t> Cell;
+  /// The indices of the static PHYs of each cell of the receiver grid
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+
+  /**
+   * Add the PHYs added to the channel since the last call to the grid.
+   */
+  void UpdateGrid (void) const;
+  /**
+   * \param position a position
+   * \returns the cell of the grid containing \p position
+   */
+  Cell GetCell (const Vector &position) const;
+  /**
+   * Add a PHY to the grid.
+   *
+   * \param i index of the YansWifiPhy in the PHY list
+   * \param mobility the mobility model of the YansWifiPhy
+   */
+  void AddToGrid (uint32_t i, Ptr<const MobilityModel> mobility) const;
+  /**
+   * Remove a PHY from the grid.
+   *
+   * \param i index of the YansWifiPhy in the PHY list
+   */
+  void RemoveFromGrid (uint32_t i) const;
+  /**
+   * Move a PHY in the grid when its mobility model changes course.
+   *
+   * \param channel the channel
+   * \param i index of the YansWifiPhy in the PHY list
+   * \param mobility the mobility model of the YansWifiPhy
+   */
+  static void CourseChanged (const YansWifiChannel *channel, uint32_t i, Ptr<const MobilityModel> mobility);
+  /**
+   * Get the PHYs which may be within a given range of a position.
+   *
+   * \param position the position
+   * \param range the range (in meters)
+   * \param phys the indices of the YansWifiPhys in the PHY list, sorted
+   */
+  void GetPhysInRange (const Vector &position, double range, std::vector<uint32_t> &phys) const;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  double m_cellSize;                   //!< Size of the cells of the receiver grid, or 0
+  mutable Grid m_grid;                 //!< Static PHYs of each cell
+  mutable std::vector<uint32_t> m_moving; //!< Moving PHYs
+  mutable std::vector<Ptr<MobilityModel> > m_gridMobility; //!< Mobility model of each PHY in the grid
+  mutable std::vector<Cell> m_gridCell; //!< Cell of each PHY in the grid
+  mutable std::vector<bool> m_gridMoving; //!< Whether each PHY in the grid is moving
+  mutable double m_gridEdThresholdDbm; //!< Lowest energy detection threshold of the PHYs in the grid
 };
 
 } //namespace ns3
@@ -25,10 +25,12 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/adhoc-wifi-mac.h"
+#include "ns3/wifi-mac-header.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
@@ -39,6 +41,10 @@
 #include "ns3/packet-socket-server.h"
 #include "ns3/packet-socket-client.h"
 #include "ns3/packet-socket-helper.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include <sstream>
 
 using namespace ns3;
 
@@ -1091,7 +1097,270 @@ Bug2222TestCase::DoRun (void)
 }
 
 //-----------------------------------------------------------------------------
+/**
+ * Make sure that the receiver grid of YansWifiChannel gives the same
+ * receptions as a visit of all the PHYs, with static and moving PHYs.
+ */
+class YansWifiChannelGridTest : public TestCase
+{
+public:
+  YansWifiChannelGridTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Run the simulation.
+   * \param cellSize the size of the cells of the receiver grid, or 0
+   */
+  void RunOne (double cellSize);
+  /**
+   * Send a broadcast packet.
+   * \param dev the sending device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * Record the start of a reception.
+   * \param context the trace context
+   * \param p the packet
+   */
+  void RxBegin (std::string context, Ptr<const Packet> p);
+  /**
+   * Count the dropped receptions.
+   * \param p the packet
+   */
+  void RxDrop (Ptr<const Packet> p);
+
+  std::ostringstream m_receptions; //!< The receptions of the run
+  uint32_t m_drops;                //!< The dropped receptions of the run
+};
+
+YansWifiChannelGridTest::YansWifiChannelGridTest ()
+  : TestCase ("Check the receiver grid of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelGridTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelGridTest::RxBegin (std::string context, Ptr<const Packet> p)
+{
+  m_receptions << Simulator::Now ().GetNanoSeconds () << " " << context << " " << p->GetSize () << std::endl;
+}
 
+void
+YansWifiChannelGridTest::RxDrop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+YansWifiChannelGridTest::RunOne (double cellSize)
+{
+  m_receptions.str ("");
+  m_drops = 0;
+
+  NodeContainer nodes;
+  nodes.Create (26);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<RangePropagationLossModel> loss = CreateObject<RangePropagationLossModel> ();
+  loss->SetAttribute ("MaxRange", DoubleValue (100));
+  channel->SetPropagationLossModel (loss);
+  channel->SetAttribute ("ReceiverGridCellSize", DoubleValue (cellSize));
+
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 0);
+
+  // 25 static nodes 60 m apart, and one crossing them
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (60),
+                                 "DeltaY", DoubleValue (60),
+                                 "GridWidth", UintegerValue (5));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  for (uint32_t i = 0; i < 25; i++)
+    {
+      mobility.Install (nodes.Get (i));
+    }
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes.Get (25));
+  Ptr<ConstantVelocityMobilityModel> moving = nodes.Get (25)->GetObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (-50, 100, 0));
+  moving->SetVelocity (Vector (50, 0, 0));
+
+  for (uint32_t round = 0; round < 8; round++)
+    {
+      for (uint32_t i = 0; i < devices.GetN (); i++)
+        {
+          Simulator::Schedule (Seconds (1 + round) + MilliSeconds (10 * i),
+                               &YansWifiChannelGridTest::SendOnePacket, this, devices.Get (i));
+        }
+    }
+  // The moving node stops in the middle of the grid
+  Simulator::Schedule (Seconds (5), &ConstantVelocityMobilityModel::SetVelocity, moving, Vector (0, 0, 0));
+
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxBegin",
+                   MakeCallback (&YansWifiChannelGridTest::RxBegin, this));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop",
+                                 MakeCallback (&YansWifiChannelGridTest::RxDrop, this));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelGridTest::DoRun (void)
+{
+  RunOne (0);
+  std::string all = m_receptions.str ();
+  uint32_t allDrops = m_drops;
+
+  RunOne (75);
+  NS_TEST_EXPECT_MSG_EQ (m_receptions.str (), all, "Same receptions with the grid");
+  NS_TEST_EXPECT_MSG_LT (m_drops, allDrops, "The grid does not visit the PHYs out of range");
+
+  // Cells smaller than the range
+  RunOne (30);
+  NS_TEST_EXPECT_MSG_EQ (m_receptions.str (), all, "Same receptions with small cells");
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a YansWifiPhy receiving a frame does not modify the
+ * packet that YansWifiChannel shares with the other receivers.
+ *
+ * Every receiver removes the MAC header of the packet it gets and tags
+ * it; each must get the packet as it was sent.
+ */
+class YansWifiSharedPacketTest : public TestCase
+{
+public:
+  YansWifiSharedPacketTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Send a broadcast packet.
+   * \param dev the sending device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * Record the size of the transmitted frame.
+   * \param p the packet
+   */
+  void TxBegin (Ptr<const Packet> p);
+  /**
+   * Check, then modify, a received frame.
+   * \param p the packet
+   * \param snr the SNR of the frame
+   * \param txVector the TXVECTOR of the frame
+   * \param preamble the preamble of the frame
+   */
+  void Receive (Ptr<Packet> p, double snr, WifiTxVector txVector, enum WifiPreamble preamble);
+
+  uint32_t m_txSize;   //!< The size of the transmitted frame
+  uint32_t m_received; //!< The number of received frames
+  uint32_t m_intact;   //!< The number of frames received as they were sent
+};
+
+YansWifiSharedPacketTest::YansWifiSharedPacketTest ()
+  : TestCase ("Check that the receivers of YansWifiChannel do not share their changes"),
+    m_txSize (0),
+    m_received (0),
+    m_intact (0)
+{
+}
+
+void
+YansWifiSharedPacketTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiSharedPacketTest::TxBegin (Ptr<const Packet> p)
+{
+  m_txSize = p->GetSize ();
+}
+
+void
+YansWifiSharedPacketTest::Receive (Ptr<Packet> p, double snr, WifiTxVector txVector, enum WifiPreamble preamble)
+{
+  SocketIpTtlTag tag;
+  m_received++;
+  if (p->GetSize () == m_txSize && !p->PeekPacketTag (tag))
+    {
+      m_intact++;
+    }
+  WifiMacHeader hdr;
+  p->RemoveHeader (hdr);
+  tag.SetTtl (1);
+  p->AddPacketTag (tag);
+}
+
+void
+YansWifiSharedPacketTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (5),
+                                 "GridWidth", UintegerValue (4));
+  mobility.Install (nodes);
+
+  // The frames go to the test instead of the MAC
+  for (uint32_t i = 1; i < devices.GetN (); i++)
+    {
+      Ptr<WifiPhy> receiver = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      receiver->SetReceiveOkCallback (MakeCallback (&YansWifiSharedPacketTest::Receive, this));
+    }
+  DynamicCast<WifiNetDevice> (devices.Get (0))->GetPhy ()->TraceConnectWithoutContext
+    ("PhyTxBegin", MakeCallback (&YansWifiSharedPacketTest::TxBegin, this));
+
+  Simulator::Schedule (Seconds (1), &YansWifiSharedPacketTest::SendOnePacket, this, devices.Get (0));
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "Every receiver got the frame");
+  NS_TEST_EXPECT_MSG_EQ (m_intact, 3, "Every receiver got the frame as it was sent");
+}
+
+//-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
 public:
@@ -1108,6 +1377,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
   AddTestCase (new SetChannelFrequencyTest, TestCase::QUICK);
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
+  AddTestCase (new YansWifiChannelGridTest, TestCase::QUICK);
+  AddTestCase (new YansWifiSharedPacketTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;